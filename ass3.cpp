@@ -2,13 +2,27 @@
 //Additional function testing by Tabitha Roemish
 //Date: February 1, 2018
 
+#include <algorithm>
 #include <iostream>
 #include <climits>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <map>
+#include <random>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
+#include "compressedgraph.h"
+#include "edgelogfollower.h"
 #include "graph.h"
+#include "graphgen.h"
+#include "graphjournal.h"
+#include "partitionedgraph.h"
+#include "relaxkernel.h"
+#include "shortestpathwriter.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // This is 80 characters - Keep all lines under 80 characters                 //
@@ -302,6 +316,1483 @@ void testGraph5()
 	cout << isOK(g.getNumEdges(), 24) << "24 edges" << endl;
 
 }
+void testGraph6()
+{
+	cout << endl;
+	cout << "test6 - graph2.txt with QueryContext" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+	QueryContext context;
+
+	// same context reused for every query
+	graphOut.str("");
+	g.depthFirstTraversal("A", graphVisitor, context);
+	cout << isOK(graphOut.str(), "A B E F J C G K L D H M I N "s)
+		<< "DFS from A" << endl;
+
+	graphOut.str("");
+	g.breadthFirstTraversal("D", graphVisitor, context);
+	cout << isOK(graphOut.str(), "D H I M N "s)
+		<< "BFS from D" << endl;
+
+	g.djikstraCostToAllVertices("O", weight, previous, context);
+	graphCostDisplay();
+	cout << isOK(graphOut.str(),
+		"P(5) Q(2) R(3) via [Q] S(6) via [Q R] " +
+		"T(8) via [Q R S] U(9) via [Q R S] "s)
+		<< "Djisktra O" << endl;
+
+	// one context per thread, all sharing the same const graph
+	const Graph& shared = g;
+	const int numThreads = 4;
+	vector<map<string, int>> weights(numThreads);
+	vector<map<string, string>> previouses(numThreads);
+	vector<thread> threads;
+	for (int t = 0; t < numThreads; ++t) {
+		threads.push_back(thread([&shared, &weights, &previouses, t]() {
+			QueryContext mine;
+			for (int i = 0; i < 100; ++i)
+				shared.djikstraCostToAllVertices(
+					"O", weights[t], previouses[t], mine);
+		}));
+	}
+	for (auto& th : threads)
+		th.join();
+	bool same = true;
+	for (int t = 0; t < numThreads; ++t)
+		same = same && weights[t] == weight && previouses[t] == previous;
+	cout << isOK(same, true) << "concurrent Djisktra O" << endl;
+}
+
+void testGraph7()
+{
+	cout << endl;
+	cout << "test7 - graph2.txt with templated visitors" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+
+	// lambda with captures, no global needed
+	ostringstream out;
+	g.depthFirstTraversal("A", [&out](const string& label) {
+		out << label << " ";
+	});
+	cout << isOK(out.str(), "A B E F J C G K L D H M I N "s)
+		<< "DFS lambda" << endl;
+
+	// a label visitor can stop too
+	out.str("");
+	g.depthFirstTraversal("A", [&out](const string& label) {
+		out << label << " ";
+		return label == "E" ? TraversalControl::Stop
+			: TraversalControl::Continue;
+	});
+	cout << isOK(out.str(), "A B E "s) << "DFS label stop" << endl;
+
+	// stop at the first vertex matching, count how many were visited
+	int visited = 0;
+	string found;
+	g.breadthFirstTraversal("A", [&](const TraversalVisit& v) {
+		++visited;
+		if (v.getLabel() == "G") {
+			found = v.getLabel();
+			return TraversalControl::Stop;
+		}
+		return TraversalControl::Continue;
+	});
+	cout << isOK(found + to_string(visited), "G7"s) << "BFS stop" << endl;
+
+	// skip everything below B and D, record depths
+	out.str("");
+	g.depthFirstTraversal("A", [&out](const TraversalVisit& v) {
+		out << v.getLabel() << v.getDepth() << " ";
+		if (v.getLabel() == "B" || v.getLabel() == "D")
+			return TraversalControl::SkipChildren;
+		return TraversalControl::Continue;
+	});
+	cout << isOK(out.str(), "A0 B1 C1 G2 K3 L3 D1 "s)
+		<< "DFS skip" << endl;
+
+	out.str("");
+	g.breadthFirstTraversal("O", [&out](const TraversalVisit& v) {
+		out << v.getLabel() << v.getDepth() << " ";
+	});
+	cout << isOK(out.str(), "O0 P1 Q1 R2 S3 T4 U4 "s)
+		<< "BFS depth" << endl;
+}
+
+void testGraph8()
+{
+	cout << endl;
+	cout << "test8 - graph2.txt with lazy dfs and bfs" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+
+	ostringstream out;
+	for (TraversalVisit v : g.dfs("A"))
+		out << v.getLabel() << " ";
+	cout << isOK(out.str(), "A B E F J C G K L D H M I N "s)
+		<< "dfs range" << endl;
+
+	out.str("");
+	for (TraversalVisit v : g.bfs("O"))
+		out << v.getLabel() << v.getDepth() << " ";
+	cout << isOK(out.str(), "O0 P1 Q1 R2 S3 T4 U4 "s)
+		<< "bfs range" << endl;
+
+	// only the first 4 reachable vertices
+	out.str("");
+	int k = 0;
+	QueryContext context;
+	for (TraversalVisit v : g.bfs("A", context)) {
+		if (k++ == 4)
+			break;
+		out << v.getLabel() << " ";
+	}
+	cout << isOK(out.str(), "A B C D "s) << "first 4 from bfs" << endl;
+
+	// two traversals interleaved, each with its own context
+	out.str("");
+	BreadthFirstRange left = g.bfs("D");
+	DepthFirstRange right = g.dfs("S");
+	auto l = left.begin();
+	auto r = right.begin();
+	while (l != left.end() || r != right.end()) {
+		if (l != left.end()) {
+			out << (*l).getLabel() << " ";
+			++l;
+		}
+		if (r != right.end()) {
+			out << (*r).getLabel() << " ";
+			++r;
+		}
+	}
+	cout << isOK(out.str(), "D S H R I O M P N Q T U "s)
+		<< "interleaved" << endl;
+}
+
+void testGraph9()
+{
+	cout << endl;
+	cout << "test9 - graph2.txt with ShortestPaths" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+	ShortestPaths paths;
+	cout << isOK(paths.getStart(), ""s) << "empty start" << endl;
+	g.djikstraCostToAllVertices("O", paths);
+	cout << isOK(paths.getStart(), "O"s) << "start O" << endl;
+
+	// same display as graphCostDisplay, but paths come out directly
+	ostringstream out;
+	for (int i = 0; i < g.getNumVertices(); ++i) {
+		string label = g.getVertexLabel(i);
+		if (!paths.isReachable(i) || label == "O")
+			continue;
+		out << label << "(" << paths.getCost(i) << ") ";
+		vector<string> path = paths.pathTo(label);
+		if (path.size() > 2) {
+			out << "via [";
+			for (size_t k = 1; k + 1 < path.size(); ++k)
+				out << path[k] << (k + 2 < path.size() ? " " : "");
+			out << "] ";
+		}
+	}
+	cout << isOK(out.str(),
+		"P(5) Q(2) R(3) via [Q] S(6) via [Q R] " +
+		"T(8) via [Q R S] U(9) via [Q R S] "s)
+		<< "Djisktra O" << endl;
+
+	cout << isOK(paths.getCost("O"), 0) << "start cost 0" << endl;
+	cout << isOK(paths.getCost("A"), INT_MAX) << "A unreachable" << endl;
+	cout << isOK(paths.pathTo("A").size(), size_t(0)) << "no path" << endl;
+}
+
+void testGraph10()
+{
+	cout << endl;
+	cout << "test10 - graph2.txt with streaming Djikstra" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+
+	// records arrive in order of increasing cost
+	ostringstream out;
+	g.djikstraStream("O", [&out](const SettledVertex& v) {
+		out << v.getLabel() << v.getCost() << v.getPreviousLabel() << " ";
+	});
+	cout << isOK(out.str(), "O0 Q2O R3Q P5O S6R T8S U9S "s)
+		<< "stream to lambda" << endl;
+
+	{
+		ShortestPathWriter writer("sssp_test.txt",
+			ShortestPathWriter::Format::Text);
+		g.djikstraStream("S", writer);
+		cout << isOK(writer.getRecordCount(), 7LL) << "7 records" << endl;
+	}
+	ifstream in("sssp_test.txt");
+	string line, all;
+	while (getline(in, line))
+		all += line + "|";
+	in.close();
+	remove("sssp_test.txt");
+	cout << isOK(all, "S   0   -|R   1   S|O   2   R|T   2   S|"s +
+		"U   3   S|Q   4   O|P   7   O|") << "text writer" << endl;
+
+	// the widest costs, 10 digits and negative
+	string a = "A";
+	string b = "B";
+	{
+		ShortestPathWriter writer("sssp_test.txt",
+			ShortestPathWriter::Format::Text);
+		writer(SettledVertex(1, b, 1500000000, 0, &a));
+		writer(SettledVertex(1, b, INT_MIN, 0, &a));
+	}
+	in.clear();
+	in.open("sssp_test.txt", ios::binary);
+	all.clear();
+	while (getline(in, line))
+		all += line + "|";
+	in.close();
+	remove("sssp_test.txt");
+	cout << isOK(all, "B   1500000000   A|B   -2147483648   A|"s)
+		<< "wide costs" << endl;
+
+	{
+		ShortestPathWriter writer("sssp_test.bin",
+			ShortestPathWriter::Format::Binary, 16);
+		g.djikstraStream("O", writer);
+	}
+	ifstream bin("sssp_test.bin", ios::binary);
+	bin.seekg(0, ios::end);
+	long long bytes = bin.tellg();
+	bin.close();
+	remove("sssp_test.bin");
+	cout << isOK(bytes, 7LL * 12) << "binary writer" << endl;
+
+	// failures are reported, not dropped
+	ShortestPathWriter nowhere("no_such_directory/sssp_test.txt",
+		ShortestPathWriter::Format::Text);
+	cout << isOK(nowhere.good(), false) << "open failure" << endl;
+	if (ifstream("/dev/full").is_open()) {  // every write fails there
+		ShortestPathWriter full("/dev/full",
+			ShortestPathWriter::Format::Binary, 64);
+		g.djikstraStream("O", full);
+		cout << isOK(full.flush(), false) << "write failure" << endl;
+		cout << isOK(full.good(), false) << "failure stays" << endl;
+	}
+}
+
+// whole file as one string
+string fileContents(const string& filename) {
+	ifstream in(filename);
+	ostringstream all;
+	all << in.rdbuf();
+	return all.str();
+}
+
+void testGraph11()
+{
+	cout << endl;
+	cout << "test11 - generated graphs" << endl;
+
+	Graph chain;
+	GraphGenerator(GraphGenerator::Topology::Chain, 7, 0, 1).generate(chain);
+	graphOut.str("");
+	chain.depthFirstTraversal("v0", graphVisitor);
+	cout << isOK(graphOut.str(), "v0 v1 v2 v3 v4 v5 v6 "s)
+		<< "chain DFS" << endl;
+
+	Graph grid;
+	GraphGenerator(GraphGenerator::Topology::Grid, 9, 0, 1).generate(grid);
+	cout << isOK(grid.getNumVertices(), 9) << "3x3 grid 9 vertices" << endl;
+	cout << isOK(grid.getNumEdges(), 24) << "3x3 grid 24 edges" << endl;
+
+	// same seed gives the same file whatever the number of threads
+	GraphGenerator one(GraphGenerator::Topology::RMat, 1000, 200000, 7);
+	GraphGenerator four(GraphGenerator::Topology::RMat, 1000, 200000, 7);
+	four.setThreads(4);
+	one.writeFile("gen_test1.txt");
+	four.writeFile("gen_test4.txt");
+	string a = fileContents("gen_test1.txt");
+	cout << isOK(a == fileContents("gen_test4.txt"), true)
+		<< "threads do not change output" << endl;
+
+	Graph rmat;
+	rmat.readFile("gen_test1.txt");
+	remove("gen_test1.txt");
+	remove("gen_test4.txt");
+	cout << isOK(a.substr(0, 7), "200000\n"s) << "edge count line" << endl;
+	cout << isOK(rmat.getNumVertices() <= 1000, true)
+		<< "rmat vertices" << endl;
+}
+
+void testGraph12()
+{
+	cout << endl;
+	cout << "test12 - graph0.txt work counters" << endl;
+	Graph g;
+	g.readFile("graph0.txt");
+	g.setAcyclicHint(false); // count Djikstra, not the DAG relaxation
+	QueryContext context;
+	g.djikstraCostToAllVertices("A", weight, previous, context);
+	const QueryCounters& dj = context.getCounters();
+	g.breadthFirstTraversal("A", graphVisitor, context);
+	const QueryCounters& bfs = context.getCounters();
+	QueryCounters total = g.getCounters();
+	if (QueryCounters::enabled) {
+		// A -> B 1, A -> C 8, B -> C 3: C is pushed twice, one is stale
+		cout << isOK(total.queries, 2LL) << "2 queries" << endl;
+		cout << isOK(total.verticesSettled, 3LL) << "3 settled" << endl;
+		cout << isOK(total.edgesRelaxed, 3LL) << "3 relaxed" << endl;
+		cout << isOK(total.heapPushes, 4LL) << "4 pushes" << endl;
+		cout << isOK(total.stalePops, 1LL) << "1 stale pop" << endl;
+		cout << isOK(bfs.vertexLookups, 3LL) << "3 BFS lookups" << endl;
+		cout << isOK(bfs.neighborResets, 3LL) << "3 BFS resets" << endl;
+		cout << isOK(total.vertexLookups, 3LL)
+			<< "Djikstra adds no lookups" << endl;
+	}
+	else {
+		cout << isOK(total.queries + dj.heapPushes + bfs.vertexLookups, 0LL)
+			<< "counters compiled out" << endl;
+	}
+	g.resetCounters();
+	cout << isOK(g.getCounters().queries, 0LL) << "reset" << endl;
+
+	// C -> B -1 makes the query Bellman-Ford, rounds {A} {B, C} {C}
+	g.add("C", "B", -1);
+	g.djikstraCostToAllVertices("A", weight, previous, context);
+	const QueryCounters& bf = context.getCounters();
+	if (QueryCounters::enabled) {
+		cout << isOK(bf.edgesRelaxed, 5LL) << "5 Bellman-Ford relaxed"
+			<< endl;
+		cout << isOK(bf.frontierHighWater, 2LL) << "Bellman-Ford frontier"
+			<< endl;
+	}
+	cout << isOK(weight["C"], 4) << "Bellman-Ford cost" << endl;
+	g.removeEdge("C", "B");
+}
+
+void testGraph13()
+{
+	cout << endl;
+	cout << "test13 - graph2.txt memory usage" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+	GraphMemoryUsage usage = g.memoryUsage();
+	cout << isOK(usage.edges, 24LL) << "24 edges" << endl;
+	cout << isOK(usage.labelBytes, size_t(0)) << "short labels" << endl;
+	cout << isOK(usage.edgePayloadBytes, 24 * sizeof(Edge))
+		<< "edge payloads" << endl;
+	cout << isOK(usage.totalBytes() > 24 * sizeof(Edge), true)
+		<< "total" << endl;
+
+	Graph longLabels;
+	longLabels.add("a label that does not fit", "another label too long", 1);
+	cout << isOK(longLabels.memoryUsage().labelBytes > 0, true)
+		<< "long labels on the heap" << endl;
+	// edges hold indices, so a label is stored once however many edges
+	size_t before = longLabels.memoryUsage().labelBytes;
+	longLabels.add("another label too long", "a label that does not fit", 2);
+	cout << isOK(longLabels.memoryUsage().labelBytes, before)
+		<< "labels not copied into edges" << endl;
+	cout << isOK(sizeof(Edge), size_t(8)) << "8 byte edges" << endl;
+	cout << g.memoryUsage().report();
+
+	// a batch gives what adding one at a time gives, the first of
+	// duplicate edges wins, self loops are dropped
+	mt19937 random(13);
+	vector<LabeledEdge> edges;
+	for (int i = 0; i < 3000; i++)
+		edges.push_back(LabeledEdge{ "v" + to_string(random() % 40),
+			"v" + to_string(random() % 40),
+			static_cast<int>(random() % 20) - 5 });
+	// past Graph's first batch, so later ones merge into a long list
+	edges.push_back(LabeledEdge{ "hub", "v1", 1 });
+	for (int i = 0; i < 66000; i++)
+		edges.push_back(LabeledEdge{ "hub", "h" + to_string(i), i });
+	Graph one;
+	int added = 0;
+	for (const LabeledEdge& e : edges)
+		added += one.add(e.start, e.end, e.weight) ? 1 : 0;
+	Graph batch;
+	cout << isOK(batch.addEdges(edges), added) << "batch count" << endl;
+	bool same = one.getNumVertices() == batch.getNumVertices() &&
+		one.getNumEdges() == batch.getNumEdges() &&
+		one.hasNegativeWeights() == batch.hasNegativeWeights();
+	for (int v = 0; v < one.getNumVertices() && same; v++)
+		same = one.getVertexLabel(v) == batch.getVertexLabel(v);
+	for (const LabeledEdge& e : edges)
+		same = same &&
+			one.getEdgeWeight(e.start, e.end) ==
+			batch.getEdgeWeight(e.start, e.end);
+	string oneDfs, batchDfs;
+	one.depthFirstTraversal("hub", [&](const string& l) { oneDfs += l; });
+	batch.depthFirstTraversal("hub", [&](const string& l) { batchDfs += l; });
+	cout << isOK(same && oneDfs == batchDfs, true) << "batch same as add"
+		<< endl;
+}
+
+void testGraph14()
+{
+	cout << endl;
+	cout << "test14 - weakly connected components" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+	for (int threads = 1; threads <= 4; threads *= 2) {
+		Components parts = g.weaklyConnectedComponents(threads);
+		string t = " with " + to_string(threads) + " threads";
+		cout << isOK(parts.getNumComponents(), 2) << "2 components" << t
+			<< endl;
+		int a = parts.getComponent("A");
+		int o = parts.getComponent("O");
+		cout << isOK(parts.getComponent("N"), a) << "A N together" << t
+			<< endl;
+		cout << isOK(parts.getComponent("U"), o) << "O U together" << t
+			<< endl;
+		cout << isOK(parts.getSize(a) * 100 + parts.getSize(o), 1407)
+			<< "sizes 14 and 7" << t << endl;
+	}
+
+	Graph g1;
+	g1.readFile("graph1.txt");
+	Components parts = g1.weaklyConnectedComponents();
+	cout << isOK(parts.getNumComponents(), 2) << "graph1 2 components"
+		<< endl;
+	cout << isOK(parts.getSize(parts.getComponent("X")), 2)
+		<< "X Y apart" << endl;
+}
+
+void testGraph15()
+{
+	cout << endl;
+	cout << "test15 - strongly connected components" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+	Components scc = g.stronglyConnectedComponents();
+	// O Q R S T P form one cycle, U and every A..N vertex alone
+	cout << isOK(scc.getNumComponents(), 16) << "16 components" << endl;
+	int o = scc.getComponent("O");
+	cout << isOK(scc.getSize(o), 6) << "O P Q R S T together" << endl;
+	cout << isOK(scc.getComponent("T"), o) << "T with O" << endl;
+	cout << isOK(scc.getSize(scc.getComponent("U")), 1) << "U alone" << endl;
+	cout << isOK(scc.getComponent("A") < scc.getComponent("M"), true)
+		<< "A before M" << endl;
+
+	Condensation dag = g.condense(scc);
+	// 14 tree edges A..N and the single edge into U
+	cout << isOK(dag.getNumEdges(), 15) << "15 DAG edges" << endl;
+	cout << isOK(dag.getOutDegree(o), 1) << "cycle -> U only" << endl;
+	bool forward = true;
+	for (int c = 0; c < dag.getNumComponents(); ++c)
+		for (int i = 0; i < dag.getOutDegree(c); ++i)
+			forward = forward && dag.getSuccessor(c, i) > c;
+	cout << isOK(forward, true) << "topological numbering" << endl;
+
+	// a chain far deeper than the call stack could recurse
+	Graph chain;
+	GraphGenerator(GraphGenerator::Topology::Chain, 200000, 0, 1)
+		.generate(chain);
+	chain.add("v199999", "v0", 1);
+	cout << isOK(chain.stronglyConnectedComponents().getNumComponents(), 1)
+		<< "200000 vertex cycle" << endl;
+}
+
+void testGraph16()
+{
+	cout << endl;
+	cout << "test16 - DAG mode" << endl;
+	Graph g0;
+	g0.readFile("graph0.txt");
+	cout << isOK(g0.isAcyclic(), true) << "graph0 acyclic" << endl;
+	vector<string> order = g0.topologicalOrder();
+	string joined;
+	for (const string& label : order)
+		joined += label + " ";
+	cout << isOK(joined, "A B C "s) << "topological order" << endl;
+
+	Graph g2;
+	g2.readFile("graph2.txt");
+	cout << isOK(g2.isAcyclic(), false) << "graph2 has a cycle" << endl;
+	cout << isOK(g2.topologicalOrder().size(), size_t(0))
+		<< "no order" << endl;
+	ShortestPaths paths;
+	cout << isOK(g2.dagShortestPaths("A", paths), false)
+		<< "no DAG paths" << endl;
+
+	// graph1 is a DAG, the result must match the Djikstra test
+	Graph g1;
+	g1.readFile("graph1.txt");
+	cout << isOK(g1.dagShortestPaths("A", paths), true) << "DAG paths" << endl;
+	cout << isOK(paths.getCost("F") * 100 + paths.getCost("G"), 504)
+		<< "F(5) G(4)" << endl;
+	g1.setAcyclicHint(false);
+	g1.djikstraCostToAllVertices("A", weight, previous);
+	map<string, int> viaDjikstra = weight;
+	g1.setAcyclicHint(true);
+	g1.djikstraCostToAllVertices("A", weight, previous);
+	cout << isOK(weight == viaDjikstra, true) << "dispatch matches" << endl;
+
+	// negative weights are fine on a DAG
+	g1.add("A", "D", -10);
+	cout << isOK(g1.isAcyclic(), true) << "still acyclic" << endl;
+	g1.dagShortestPaths("A", paths);
+	cout << isOK(paths.getCost("F"), -8) << "negative edge" << endl;
+	g1.add("F", "A", 1);
+	cout << isOK(g1.isAcyclic(), false) << "cycle after add" << endl;
+	g1.removeEdge("F", "A");
+	cout << isOK(g1.isAcyclic(), true) << "acyclic after remove" << endl;
+}
+
+void testGraph17()
+{
+	cout << endl;
+	cout << "test17 - k shortest paths" << endl;
+	Graph g;
+	g.add("C", "D", 3);
+	g.add("C", "E", 2);
+	g.add("D", "F", 4);
+	g.add("E", "D", 1);
+	g.add("E", "F", 2);
+	g.add("E", "G", 3);
+	g.add("F", "G", 2);
+	g.add("F", "H", 1);
+	g.add("G", "H", 2);
+
+	vector<WeightedPath> paths = g.kShortestPaths("C", "H", 3);
+	ostringstream out;
+	for (const WeightedPath& p : paths) {
+		for (const string& label : p.getVertices())
+			out << label;
+		out << "(" << p.getCost() << ") ";
+	}
+	cout << isOK(out.str(), "CEFH(5) CEGH(7) CDFH(8) "s) << "3 paths" << endl;
+	cout << isOK(g.getNumEdges(), 9) << "graph unchanged" << endl;
+
+	// C to H has 7 loopless paths in all
+	cout << isOK(g.kShortestPaths("C", "H", 100).size(), size_t(7))
+		<< "all paths" << endl;
+	cout << isOK(g.kShortestPaths("H", "C", 3).size(), size_t(0))
+		<< "no path" << endl;
+
+	g.add("H", "E", -1);
+	bool threw = false;
+	try {
+		g.kShortestPaths("C", "H", 3);
+	}
+	catch (const std::domain_error&) {
+		threw = true;
+	}
+	cout << isOK(threw, true) << "negative weights refused" << endl;
+}
+
+void testGraph18()
+{
+	cout << endl;
+	cout << "test18 - hashed label lookup" << endl;
+	Graph g;
+	// enough vertices to grow the table several times
+	for (int i = 0; i < 5000; i++)
+		g.add("v" + to_string(i), "v" + to_string((i * 7 + 1) % 5000), i % 9);
+	cout << isOK(g.getNumVertices(), 5000) << "5000 vertices" << endl;
+	bool allFound = true;
+	for (int i = 0; i < 5000; i++) {
+		int index = g.getVertexIndex("v" + to_string(i));
+		if (index < 0 || g.getVertexLabel(index) != "v" + to_string(i))
+			allFound = false;
+	}
+	cout << isOK(allFound, true) << "every label found" << endl;
+	cout << isOK(g.getVertexIndex("v5000"), -1) << "missing label" << endl;
+	cout << isOK(g.getEdgeWeight("v3", "v22"), 3) << "edge weight" << endl;
+
+	bool sorted = true;
+	vector<int> order = g.sortedVertexIndices();
+	for (size_t i = 1; i < order.size(); i++)
+		if (g.getVertexLabel(order[i - 1]) >= g.getVertexLabel(order[i]))
+			sorted = false;
+	cout << isOK(order.size(), size_t(5000)) << "sorted view size" << endl;
+	cout << isOK(sorted, true) << "sorted view in label order" << endl;
+}
+
+void testGraph19()
+{
+	cout << endl;
+	cout << "test19 - compressed adjacency" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+	CompressedGraph c(g);
+	cout << isOK(c.getNumVertices(), g.getNumVertices()) << "vertices" << endl;
+	cout << isOK(c.getNumEdges(), static_cast<long long>(g.getNumEdges()))
+		<< "edges" << endl;
+	cout << isOK(c.getVertexLabel(0), "A"s) << "ids in label order" << endl;
+
+	string graphDfs, compressedDfs, graphBfs, compressedBfs;
+	g.depthFirstTraversal("A", [&](const string& l) { graphDfs += l; });
+	c.depthFirstTraversal("A", [&](const string& l) { compressedDfs += l; });
+	g.breadthFirstTraversal("O", [&](const string& l) { graphBfs += l; });
+	c.breadthFirstTraversal("O", [&](const string& l) { compressedBfs += l; });
+	cout << isOK(compressedDfs, graphDfs) << "same DFS" << endl;
+	cout << isOK(compressedBfs, graphBfs) << "same BFS" << endl;
+
+	map<string, int> weight, cWeight;
+	map<string, string> previous, cPrevious;
+	g.djikstraCostToAllVertices("A", weight, previous);
+	c.djikstraCostToAllVertices("A", cWeight, cPrevious);
+	cout << isOK(cWeight == weight && cPrevious == previous, true)
+		<< "same Djikstra" << endl;
+	cout << isOK(c.getEdgeWeight("A", "B"), g.getEdgeWeight("A", "B"))
+		<< "edge weight" << endl;
+	cout << isOK(c.getEdgeWeight("B", "A"), INT_MAX) << "no edge" << endl;
+
+	// a bigger generated graph, every vertex as a start
+	Graph rmat;
+	GraphGenerator gen(GraphGenerator::Topology::RMat, 2000, 30000, 3);
+	gen.setMaxWeight(100);
+	gen.generate(rmat);
+	rmat.setAcyclicHint(false);
+	CompressedGraph crmat(rmat);
+	cout << isOK(crmat.getWeightBits(), 7) << "7 bit weights" << endl;
+	bool same = true;
+	QueryContext context;
+	for (int v = 0; v < rmat.getNumVertices() && same; v += 97) {
+		const string& label = rmat.getVertexLabel(v);
+		rmat.djikstraCostToAllVertices(label, weight, previous, context);
+		crmat.djikstraCostToAllVertices(label, cWeight, cPrevious, context);
+		same = cWeight == weight;
+		graphDfs.clear();
+		compressedDfs.clear();
+		rmat.depthFirstTraversal(label,
+			[&](const string& l) { graphDfs += l; }, context);
+		crmat.depthFirstTraversal(label,
+			[&](const string& l) { compressedDfs += l; }, context);
+		same = same && graphDfs == compressedDfs;
+	}
+	cout << isOK(same, true) << "same results on rmat" << endl;
+
+	GraphMemoryUsage usage = rmat.memoryUsage();
+	// against the 8 bytes an edge takes, whatever the vectors' slack
+	cout << isOK(crmat.adjacencyBytes() * 2 < usage.edgePayloadBytes, true)
+		<< "adjacency over 2 times smaller" << endl;
+}
+
+void testGraph20()
+{
+	cout << endl;
+	cout << "test20 - memory mapped compressed graph" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+	CompressedGraph built(g);
+	cout << isOK(built.writeFile("compressed_test.bin"), true)
+		<< "written" << endl;
+	CompressedGraph mapped("compressed_test.bin",
+		MappedFile::Advice::Sequential);
+	cout << isOK(mapped.isOpen() && mapped.isMapped(), true)
+		<< "mapped" << endl;
+	cout << isOK(mapped.getNumEdges(), built.getNumEdges()) << "edges" << endl;
+
+	mapped.setReadahead(4);
+	string graphBfs, mappedBfs, graphDfs, mappedDfs;
+	g.breadthFirstTraversal("A", [&](const string& l) { graphBfs += l; });
+	mapped.breadthFirstTraversal("A", [&](const string& l) { mappedBfs += l; });
+	g.depthFirstTraversal("O", [&](const string& l) { graphDfs += l; });
+	mapped.depthFirstTraversal("O", [&](const string& l) { mappedDfs += l; });
+	cout << isOK(mappedBfs, graphBfs) << "same BFS" << endl;
+	cout << isOK(mappedDfs, graphDfs) << "same DFS" << endl;
+
+	map<string, int> weight, mWeight;
+	map<string, string> previous, mPrevious;
+	g.djikstraCostToAllVertices("A", weight, previous);
+	mapped.djikstraCostToAllVertices("A", mWeight, mPrevious);
+	cout << isOK(mWeight == weight && mPrevious == previous, true)
+		<< "same Djikstra" << endl;
+
+	// moving keeps the mapping
+	CompressedGraph moved(std::move(mapped));
+	cout << isOK(moved.getEdgeWeight("A", "B"), g.getEdgeWeight("A", "B"))
+		<< "moved" << endl;
+
+	// a larger graph with weights spanning words
+	Graph rmat;
+	GraphGenerator gen(GraphGenerator::Topology::RMat, 5000, 60000, 5);
+	gen.setMaxWeight(100000);
+	gen.generate(rmat);
+	CompressedGraph(rmat).writeFile("compressed_test.bin");
+	CompressedGraph big("compressed_test.bin", MappedFile::Advice::Random);
+	big.setReadahead(64);
+	bool same = big.isOpen();
+	for (int v = 0; v < rmat.getNumVertices() && same; v += 331) {
+		const string& label = rmat.getVertexLabel(v);
+		graphBfs.clear();
+		mappedBfs.clear();
+		rmat.breadthFirstTraversal(label,
+			[&](const string& l) { graphBfs += l; });
+		big.breadthFirstTraversal(label,
+			[&](const string& l) { mappedBfs += l; });
+		rmat.djikstraCostToAllVertices(label, weight, previous);
+		big.djikstraCostToAllVertices(label, mWeight, mPrevious);
+		same = graphBfs == mappedBfs && weight == mWeight;
+	}
+	cout << isOK(same, true) << "same results on rmat" << endl;
+
+	ofstream bad("compressed_test.bin", ios::binary | ios::trunc);
+	bad << "not a graph file, just some text long enough for a header"
+		<< " to be read from it, which then fails the check";
+	bad.close();
+	cout << isOK(CompressedGraph("compressed_test.bin").isOpen(), false)
+		<< "bad file" << endl;
+	remove("compressed_test.bin");
+	CompressedGraph missing("compressed_test.bin");
+	cout << isOK(missing.isOpen(), false) << "missing file" << endl;
+	cout << isOK(missing.getNumVertices(), 0) << "empty" << endl;
+}
+
+void testGraph21()
+{
+	cout << endl;
+	cout << "test21 - partitioned workers" << endl;
+	Graph g;
+	g.readFile("graph2.txt");
+	for (PartitionedGraph::Partitioning how :
+		{ PartitionedGraph::Partitioning::Hash,
+		PartitionedGraph::Partitioning::EdgeCut }) {
+		string name = how == PartitionedGraph::Partitioning::Hash ?
+			"hash " : "edge cut ";
+		PartitionedGraph parts(g, 3, how);
+		graphOut.str("");
+		g.breadthFirstTraversal("A", graphVisitor);
+		string single = graphOut.str();
+		graphOut.str("");
+		parts.breadthFirstTraversal("A", graphVisitor);
+		cout << isOK(graphOut.str(), single) << name << "same BFS" << endl;
+
+		map<string, int> weight, pWeight;
+		map<string, string> previous, pPrevious;
+		g.djikstraCostToAllVertices("A", weight, previous);
+		parts.djikstraCostToAllVertices("A", pWeight, pPrevious);
+		cout << isOK(pWeight == weight, true) << name << "same costs" << endl;
+		cout << isOK(parts.getLastStats().supersteps > 0, true)
+			<< name << "supersteps" << endl;
+	}
+
+	// every start on a generated graph, previous must be on a shortest path
+	Graph rmat;
+	GraphGenerator gen(GraphGenerator::Topology::RMat, 3000, 20000, 11);
+	gen.setMaxWeight(50);
+	gen.generate(rmat);
+	rmat.setAcyclicHint(false);
+	PartitionedGraph parts(rmat, 4, PartitionedGraph::Partitioning::Hash);
+	bool same = true;
+	long long messages = 0;
+	size_t reached = 0;
+	for (int v = 0; v < rmat.getNumVertices() && same; v += 257) {
+		const string& label = rmat.getVertexLabel(v);
+		vector<int> order;
+		rmat.breadthFirstTraversal(label,
+			[&order](const TraversalVisit& visit) {
+			order.push_back(visit.getIndex());
+		});
+		same = parts.breadthFirstOrder(label) == order;
+		messages += parts.getLastStats().messages;
+		reached = max(reached, order.size());
+
+		map<string, int> weight, pWeight;
+		map<string, string> previous, pPrevious;
+		rmat.djikstraCostToAllVertices(label, weight, previous);
+		parts.djikstraCostToAllVertices(label, pWeight, pPrevious);
+		same = same && pWeight == weight;
+		for (const auto& p : pPrevious) {
+			int before = p.second == label ? 0 : pWeight[p.second];
+			if (before + rmat.getEdgeWeight(p.second, p.first) !=
+				pWeight[p.first])
+				same = false;
+		}
+	}
+	cout << isOK(same, true) << "same results on rmat" << endl;
+	cout << isOK(reached > 1000 && messages > 0, true)
+		<< "messages sent" << endl;
+
+	// a grid has locality that hashing throws away
+	Graph grid;
+	GraphGenerator(GraphGenerator::Topology::Grid, 400, 0, 1).generate(grid);
+	PartitionedGraph hashed(grid, 4, PartitionedGraph::Partitioning::Hash);
+	PartitionedGraph cut(grid, 4, PartitionedGraph::Partitioning::EdgeCut);
+	cout << isOK(cut.getCutEdges() * 2 < hashed.getCutEdges(), true)
+		<< "edge cut partitioning cuts fewer edges" << endl;
+	cout << isOK(cut.getPartitionSize(0) + cut.getPartitionSize(1) +
+		cut.getPartitionSize(2) + cut.getPartitionSize(3), 400)
+		<< "every vertex owned" << endl;
+	cout << isOK(cut.getPartitionSize(3), 100) << "even sizes" << endl;
+
+	// supersteps are Bellman-Ford rounds, a negative cycle stops them
+	Graph rebate;
+	rebate.add("A", "B", 4);
+	rebate.add("A", "C", 2);
+	rebate.add("C", "B", -3);
+	rebate.add("B", "D", 1);
+	PartitionedGraph rebateParts(rebate, 2,
+		PartitionedGraph::Partitioning::Hash);
+	map<string, int> weight, pWeight;
+	map<string, string> previous, pPrevious;
+	rebate.djikstraCostToAllVertices("A", weight, previous);
+	rebateParts.djikstraCostToAllVertices("A", pWeight, pPrevious);
+	cout << isOK(pWeight == weight, true) << "negative weights" << endl;
+	rebate.add("B", "C", 1);
+	PartitionedGraph cycleParts(rebate, 2,
+		PartitionedGraph::Partitioning::Hash);
+	bool threw = false;
+	try {
+		cycleParts.djikstraCostToAllVertices("A", pWeight, pPrevious);
+	}
+	catch (const domain_error&) {
+		threw = true;
+	}
+	cout << isOK(threw, true) << "negative cycle stops" << endl;
+}
+
+void testGraph22()
+{
+	cout << endl;
+	cout << "test22 - relaxation kernels" << endl;
+	// random edges against random costs, lengths that leave tails
+	mt19937 random(22);
+	const int numVertices = 1000;
+	vector<int> distance(numVertices);
+	vector<unsigned int> marks(numVertices);
+	for (int v = 0; v < numVertices; v++) {
+		distance[v] = random() % 200;
+		marks[v] = random() % 2 == 0 ? 5 : 4; // epoch 5 is reached
+	}
+	RelaxKernel best = getRelaxKernel();
+	cout << isOK(isRelaxKernelSupported(RelaxKernel::Scalar), true)
+		<< "scalar always there" << endl;
+	for (RelaxKernel kernel :
+		{ RelaxKernel::Scalar, RelaxKernel::Avx2, RelaxKernel::Avx512 }) {
+		if (!setRelaxKernel(kernel))
+			continue;
+		bool same = true;
+		for (int count : { 0, 1, 7, 8, 15, 16, 17, 33, 100 }) {
+			vector<Edge> edges;
+			for (int i = 0; i < count; i++)
+				edges.push_back(Edge(random() % numVertices, random() % 100));
+			vector<int> expected;
+			for (int i = 0; i < count; i++) {
+				int u = edges[i].getEndVertex();
+				int now = marks[u] == 5 ? distance[u] : INT_MAX;
+				if (50 + edges[i].getWeight() < now)
+					expected.push_back(i);
+			}
+			vector<int> improved(count + 1);
+			int found = relaxEdges(edges.data(), count, 50, distance.data(),
+				marks.data(), 5, improved.data());
+			improved.resize(found);
+			same = same && improved == expected;
+		}
+
+		Graph rmat;
+		GraphGenerator gen(GraphGenerator::Topology::RMat, 2000, 40000, 9);
+		gen.setMaxWeight(30);
+		gen.generate(rmat);
+		rmat.setAcyclicHint(false);
+		setRelaxKernel(RelaxKernel::Scalar);
+		map<string, int> weight, kWeight;
+		map<string, string> previous, kPrevious;
+		rmat.djikstraCostToAllVertices("v0", weight, previous);
+		setRelaxKernel(kernel);
+		rmat.djikstraCostToAllVertices("v0", kWeight, kPrevious);
+		same = same && weight == kWeight && previous == kPrevious;
+		cout << isOK(same, true) << "kernel " << static_cast<int>(kernel)
+			<< " same as scalar" << endl;
+	}
+	setRelaxKernel(best);
+}
+
+void testGraph23()
+{
+	cout << endl;
+	cout << "test23 - negative weights" << endl;
+	// a rebate on C->B, the cycle A->C->B->A costs 0
+	Graph g;
+	g.add("A", "B", 4);
+	g.add("A", "C", 2);
+	g.add("C", "B", -3);
+	g.add("B", "A", 1);
+	cout << isOK(g.hasNegativeWeights(), true) << "has negative" << endl;
+	g.add("C", "E", -1);
+	cout << isOK(g.getEdgeWeight("C", "E"), -1) << "weight -1" << endl;
+	cout << isOK(g.getEdgeWeight("E", "C"), INT_MAX) << "no edge" << endl;
+	cout << isOK(g.getEdgeWeight("C", "Z"), INT_MAX) << "no vertex" << endl;
+	g.removeEdge("C", "E");
+	map<string, int> weight;
+	map<string, string> previous;
+	g.djikstraCostToAllVertices("A", weight, previous);
+	cout << isOK(weight["B"], -1) << "cost with rebate" << endl;
+	cout << isOK(previous["B"], string("C")) << "path with rebate" << endl;
+	bool thrownStream = false;
+	try {
+		g.djikstraStream("A", [](const SettledVertex&) {});
+	}
+	catch (const domain_error&) {
+		thrownStream = true;
+	}
+	cout << isOK(thrownStream, true) << "stream refuses negative" << endl;
+	CompressedGraph compressed(g);
+	bool thrownCompressed = false;
+	try {
+		compressed.djikstraCostToAllVertices("A", weight, previous);
+	}
+	catch (const domain_error&) {
+		thrownCompressed = true;
+	}
+	cout << isOK(thrownCompressed, true) << "compressed refuses negative"
+		<< endl;
+	ShortestPaths paths;
+	cout << isOK(g.bellmanFordShortestPaths("A", paths), true)
+		<< "no negative cycle" << endl;
+	cout << isOK(paths.pathTo("B").size(), static_cast<size_t>(3))
+		<< "A C B" << endl;
+
+	// C->B->C costs -2
+	g.add("B", "C", 1);
+	cout << isOK(g.bellmanFordShortestPaths("A", paths, 4), false)
+		<< "negative cycle found" << endl;
+	cout << isOK(paths.getStartIndex(), -1) << "empty result" << endl;
+	bool thrown = false;
+	try {
+		g.djikstraCostToAllVertices("A", weight, previous);
+	}
+	catch (const domain_error&) {
+		thrown = true;
+	}
+	cout << isOK(thrown, true) << "Djikstra refuses negative cycle" << endl;
+	vector<ShortestPaths> all;
+	cout << isOK(g.allPairsShortestPaths(all), false)
+		<< "all pairs refuses negative cycle" << endl;
+	g.removeEdge("B", "C");
+	g.removeEdge("C", "B");
+	cout << isOK(g.hasNegativeWeights(), false) << "rebate removed" << endl;
+
+	// weight + p[to] - p[from] >= 0 for a random p, so no negative cycle
+	mt19937 random(23);
+	const int numVertices = 2000;
+	vector<int> potential(numVertices);
+	for (int v = 0; v < numVertices; v++)
+		potential[v] = random() % 40;
+	Graph rebates;
+	for (int i = 0; i < 12000; i++) {
+		int from = random() % numVertices;
+		int to = random() % numVertices;
+		if (from != to)
+			rebates.add("v" + to_string(from), "v" + to_string(to),
+				static_cast<int>(random() % 20) + potential[to] -
+				potential[from]);
+	}
+	cout << isOK(rebates.hasNegativeWeights(), true) << "random rebates"
+		<< endl;
+	cout << isOK(rebates.allPairsShortestPaths(all, 4), true)
+		<< "all pairs" << endl;
+	cout << isOK(all.size(), static_cast<size_t>(rebates.getNumVertices()))
+		<< "one result per vertex" << endl;
+	bool same = true;
+	bool threadsAgree = true;
+	for (int s = 0; s < rebates.getNumVertices(); s += 97) {
+		ShortestPaths one, four;
+		rebates.bellmanFordShortestPaths(rebates.getVertexLabel(s), one, 1);
+		rebates.bellmanFordShortestPaths(rebates.getVertexLabel(s), four, 4);
+		threadsAgree = threadsAgree && one.getCosts() == four.getCosts();
+		same = same && all[s].getCosts() == one.getCosts() &&
+			all[s].getStartIndex() == s;
+	}
+	cout << isOK(threadsAgree, true) << "Bellman-Ford threads agree" << endl;
+	cout << isOK(same, true) << "Johnson matches Bellman-Ford" << endl;
+
+	// every path's edges add up to its cost
+	bool consistent = true;
+	ShortestPaths& last = all[numVertices / 2];
+	for (int v = 0; v < rebates.getNumVertices(); v++) {
+		vector<string> path = last.pathTo(rebates.getVertexLabel(v));
+		int total = 0;
+		for (size_t i = 1; i < path.size(); i++)
+			total += rebates.getEdgeWeight(path[i - 1], path[i]);
+		if (!path.empty() && total != last.getCost(v))
+			consistent = false;
+	}
+	cout << isOK(consistent, true) << "paths add up" << endl;
+}
+
+void testGraph24()
+{
+	cout << endl;
+	cout << "test24 - following an edge log" << endl;
+	remove("edgelog_test.txt");
+	Graph g;
+	EdgeLogFollower follower("edgelog_test.txt");
+	EdgeLogFollower::Batch batch = follower.poll(g);
+	cout << isOK(batch.added + batch.skipped, 0) << "no log yet" << endl;
+
+	// the writer is caught in the middle of "C D 5"
+	ofstream log("edgelog_test.txt", ios::binary);
+	log << "3\nA B 1\r\nB C 2\nC D";
+	log.flush();
+	batch = follower.poll(g);
+	cout << isOK(batch.added, 2) << "complete lines added" << endl;
+	cout << isOK(follower.getOffset(), 15LL) << "offset before partial"
+		<< endl;
+	cout << isOK(g.getNumEdges(), 2) << "partial line left" << endl;
+
+	log << " 5\n- A B\nX Y\n- Q R\n- B D\nB C 7\n\n";
+	log.flush();
+	batch = follower.poll(g);
+	cout << isOK(batch.added, 1) << "rest of the line" << endl;
+	cout << isOK(batch.removed, 1) << "delete record" << endl;
+	cout << isOK(batch.skipped, 4) << "bad and redundant lines" << endl;
+	cout << isOK(g.getNumEdges(), 2) << "edges after batch" << endl;
+	cout << isOK(g.getEdgeWeight("C", "D"), 5) << "joined line" << endl;
+	cout << isOK(g.getEdgeWeight("B", "C"), 2) << "no duplicate" << endl;
+	batch = follower.poll(g);
+	cout << isOK(batch.added + batch.removed + batch.skipped, 0)
+		<< "nothing new" << endl;
+
+	// a restarted process resumes from the saved offset
+	log << "D E 4\n";
+	log.flush();
+	long long saved = follower.getOffset();
+	EdgeLogFollower resumed("edgelog_test.txt", saved);
+	batch = resumed.poll(g);
+	cout << isOK(batch.added, 1) << "resumed at offset" << endl;
+	cout << isOK(g.getNumEdges(), 3) << "only the new edge" << endl;
+	log.close();
+
+	ofstream replaced("edgelog_test.txt", ios::binary | ios::trunc);
+	replaced << "1\nA B 1\n";
+	replaced.close();
+	cout << isOK(resumed.poll(g).truncated, true) << "replaced log" << endl;
+
+	// graph2.txt has no newline after its last edge, which waits
+	Graph fromFile, followed;
+	fromFile.readFile("graph2.txt");
+	ifstream original("graph2.txt", ios::binary);
+	ofstream copy("edgelog_test.txt", ios::binary | ios::trunc);
+	copy << original.rdbuf();
+	copy.flush();
+	EdgeLogFollower whole("edgelog_test.txt");
+	whole.poll(followed);
+	cout << isOK(followed.getNumEdges(), fromFile.getNumEdges() - 1)
+		<< "last line waits for newline" << endl;
+	copy << "\n";
+	copy.close();
+	whole.poll(followed);
+	cout << isOK(followed.getNumEdges(), fromFile.getNumEdges())
+		<< "same as readFile" << endl;
+	remove("edgelog_test.txt");
+}
+
+// true if both graphs have the same vertices with the same indices
+// and the same edges
+bool sameGraph(const Graph& a, const Graph& b)
+{
+	if (a.getNumVertices() != b.getNumVertices() ||
+		a.getNumEdges() != b.getNumEdges())
+		return false;
+	for (int i = 0; i < a.getNumVertices(); i++)
+		if (a.getVertexLabel(i) != b.getVertexLabel(i))
+			return false;
+	for (int i = 0; i < a.getNumVertices(); i++)
+		for (int j = 0; j < a.getNumVertices(); j++)
+			if (a.getEdgeWeight(a.getVertexLabel(i), a.getVertexLabel(j)) !=
+				b.getEdgeWeight(b.getVertexLabel(i), b.getVertexLabel(j)))
+				return false;
+	return true;
+}
+
+void testGraph25()
+{
+	cout << endl;
+	cout << "test25 - journal and checkpoints" << endl;
+	remove("journal_test.checkpoint");
+	remove("journal_test.journal");
+	Graph g;
+	{
+		GraphJournal journal("journal_test");
+		cout << isOK(journal.recover(g), true) << "first run" << endl;
+		g.add("A", "B", 1);
+		g.add("B", "C", 2);
+		g.add("C", "A", -1);
+		g.removeEdge("A", "B");
+		g.removeEdge("A", "C"); // not there, not recorded
+		g.add("B", "C", 9);     // already there, not recorded
+		g.add("X", "X", 1);     // no edge, but X is created
+		cout << isOK(journal.getRecordCount(), 5LL) << "records" << endl;
+		cout << isOK(journal.recover(g), false) << "recover once" << endl;
+	}
+	{
+		Graph restarted;
+		GraphJournal journal("journal_test");
+		cout << isOK(journal.recover(restarted), true) << "replay" << endl;
+		cout << isOK(journal.getReplayedCount(), 5LL) << "replayed" << endl;
+		cout << isOK(sameGraph(g, restarted), true) << "same graph" << endl;
+		cout << isOK(restarted.hasNegativeWeights(), true)
+			<< "negative weight" << endl;
+		cout << isOK(journal.checkpoint(), true) << "checkpoint" << endl;
+		restarted.add("D", "E", 3);
+		g.add("D", "E", 3);
+	}
+	{
+		Graph restarted;
+		GraphJournal journal("journal_test");
+		journal.recover(restarted);
+		cout << isOK(journal.getGeneration(), static_cast<uint64_t>(1))
+			<< "generation" << endl;
+		cout << isOK(journal.getReplayedCount(), 1LL) << "only the tail"
+			<< endl;
+		cout << isOK(sameGraph(g, restarted), true) << "checkpoint and tail"
+			<< endl;
+	}
+
+	// a crash in the middle of a record leaves part of it
+	ofstream torn("journal_test.journal", ios::binary | ios::app);
+	torn.put(1);
+	torn.put(static_cast<char>(0x83));
+	torn.close();
+	{
+		Graph restarted;
+		GraphJournal journal("journal_test");
+		cout << isOK(journal.recover(restarted), true) << "torn record"
+			<< endl;
+		cout << isOK(sameGraph(g, restarted), true) << "torn record dropped"
+			<< endl;
+		restarted.add("E", "F", 4);
+		g.add("E", "F", 4);
+	}
+
+	// many edits with checkpoints along the way
+	mt19937 random(25);
+	{
+		Graph restarted;
+		GraphJournal journal("journal_test");
+		journal.recover(restarted);
+		journal.setCheckpointInterval(300);
+		journal.setFlushInterval(64);
+		for (int i = 0; i < 2000; i++) {
+			string from = "v" + to_string(random() % 60);
+			string to = "v" + to_string(random() % 60);
+			if (random() % 4 == 0 && g.getVertexIndex(from) != -1) {
+				g.removeEdge(from, to);
+				restarted.removeEdge(from, to);
+			}
+			else {
+				int weight = static_cast<int>(random() % 50) - 10;
+				g.add(from, to, weight);
+				restarted.add(from, to, weight);
+			}
+		}
+		cout << isOK(journal.getGeneration() > 3, true)
+			<< "checkpoints by interval" << endl;
+	}
+	Graph restarted;
+	GraphJournal journal("journal_test");
+	journal.recover(restarted);
+	cout << isOK(sameGraph(g, restarted), true) << "same after edits" << endl;
+	Graph notEmpty;
+	notEmpty.add("A", "B", 1);
+	GraphJournal other("journal_test");
+	cout << isOK(other.recover(notEmpty), false) << "needs empty graph"
+		<< endl;
+	remove("journal_test.checkpoint");
+	remove("journal_test.journal");
+
+	// a journal that cannot be written stops recording and says so
+	{
+		Graph failing;
+		GraphJournal broken("journal_test");
+		broken.recover(failing);
+		failing.add("A", "B", 1);
+		cout << isOK(broken.isHealthy(), true) << "healthy" << endl;
+		remove("journal_test.journal");
+		filesystem::create_directories("journal_test.journal/blocked");
+		cout << isOK(broken.checkpoint(), false) << "new journal blocked"
+			<< endl;
+		cout << isOK(broken.isHealthy(), false) << "failure reported" << endl;
+		failing.add("B", "C", 2);
+		cout << isOK(broken.getRecordCount(), 0LL) << "nothing recorded"
+			<< endl;
+		filesystem::remove_all("journal_test.journal");
+		cout << isOK(broken.checkpoint(), true) << "checkpoint again"
+			<< endl;
+		cout << isOK(broken.isHealthy(), true) << "healthy again" << endl;
+		failing.add("C", "D", 3);
+	}
+	Graph healed;
+	GraphJournal healedJournal("journal_test");
+	healedJournal.recover(healed);
+	cout << isOK(healed.getNumEdges(), 3) << "nothing lost after healing"
+		<< endl;
+	remove("journal_test.checkpoint");
+	remove("journal_test.journal");
+}
+
+// true if the compressed graph gives the same Djikstra and BFS as g
+bool sameQueries(const Graph& g, const CompressedGraph& c)
+{
+	bool same = c.getNumEdges() == g.getNumEdges();
+	long long degrees = 0;
+	for (int v = 0; v < c.getNumVertices(); v++)
+		degrees += c.getOutDegree(v);
+	same = same && degrees == c.getNumEdges();
+	for (int s = 0; s < g.getNumVertices() && same; s += 250) {
+		const string& start = g.getVertexLabel(s);
+		map<string, int> weight, cWeight;
+		map<string, string> previous, cPrevious;
+		g.djikstraCostToAllVertices(start, weight, previous);
+		c.djikstraCostToAllVertices(start, cWeight, cPrevious);
+		string bfs, cBfs;
+		g.breadthFirstTraversal(start, [&](const string& l) { bfs += l; });
+		c.breadthFirstTraversal(start, [&](const string& l) { cBfs += l; });
+		same = cWeight == weight && bfs == cBfs;
+	}
+	return same;
+}
+
+void testGraph26()
+{
+	cout << endl;
+	cout << "test26 - tombstones and compaction" << endl;
+	Graph g;
+	GraphGenerator gen(GraphGenerator::Topology::RMat, 2000, 30000, 26);
+	gen.setMaxWeight(100);
+	gen.generate(g);
+	g.setAcyclicHint(false);
+	CompressedGraph c(g);
+	vector<pair<string, string>> edges;
+	for (int v = 0; v < c.getNumVertices(); v++)
+		c.forEachNeighbor(v, [&](int to, int) {
+			edges.push_back(make_pair(c.getVertexLabel(v),
+				c.getVertexLabel(to)));
+		});
+	mt19937 random(26);
+	shuffle(edges.begin(), edges.end(), random);
+
+	c.setCompaction(0, false);
+	size_t removals = edges.size() / 5;
+	bool removed = true;
+	for (size_t i = 0; i < removals; i++)
+		removed = removed && g.removeEdge(edges[i].first, edges[i].second) &&
+			c.removeEdge(edges[i].first, edges[i].second);
+	cout << isOK(removed, true) << "edges removed" << endl;
+	cout << isOK(c.removeEdge(edges[0].first, edges[0].second), false)
+		<< "already removed" << endl;
+	cout << isOK(c.getTombstoneCount(), static_cast<long long>(removals))
+		<< "tombstones" << endl;
+	cout << isOK(c.getEdgeWeight(edges[0].first, edges[0].second), INT_MAX)
+		<< "removed edge weight" << endl;
+	cout << isOK(sameQueries(g, c), true) << "queries skip tombstones"
+		<< endl;
+	c.writeFile("compressed_test.bin");
+	size_t before = c.adjacencyBytes();
+	c.compact();
+	cout << isOK(c.getTombstoneCount(), 0LL) << "compacted" << endl;
+	cout << isOK(c.adjacencyBytes() < before, true) << "smaller" << endl;
+	cout << isOK(sameQueries(g, c), true) << "same after compaction" << endl;
+
+	// a mapped file without the removed edges, then compacted in memory
+	CompressedGraph mapped("compressed_test.bin");
+	cout << isOK(mapped.getNumEdges(), c.getNumEdges())
+		<< "file leaves tombstones out" << endl;
+	size_t next = removals;
+	for (; next < removals + 100; next++) {
+		g.removeEdge(edges[next].first, edges[next].second);
+		c.removeEdge(edges[next].first, edges[next].second);
+		mapped.removeEdge(edges[next].first, edges[next].second);
+	}
+	mapped.compact();
+	cout << isOK(mapped.isMapped(), false) << "compacted into memory"
+		<< endl;
+	cout << isOK(sameQueries(g, mapped), true) << "same as mapped" << endl;
+
+	// background, with edges removed while it runs
+	c.setCompaction(0.1, true);
+	while (!c.isCompacting() && next < edges.size()) {
+		g.removeEdge(edges[next].first, edges[next].second);
+		c.removeEdge(edges[next].first, edges[next].second);
+		next++;
+	}
+	cout << isOK(c.isCompacting(), true) << "threshold reached" << endl;
+	CompressedGraph moved(std::move(c));
+	for (size_t stop = next + 50; next < stop; next++) {
+		g.removeEdge(edges[next].first, edges[next].second);
+		moved.removeEdge(edges[next].first, edges[next].second);
+	}
+	moved.finishCompaction();
+	cout << isOK(moved.isCompacting(), false) << "swapped in" << endl;
+	cout << isOK(moved.getTombstoneCount() <= 50, true)
+		<< "later tombstones kept" << endl;
+	cout << isOK(sameQueries(g, moved), true) << "same after background"
+		<< endl;
+	remove("compressed_test.bin");
+}
+
+void testGraph27()
+{
+	cout << endl;
+	cout << "test27 - updating weights" << endl;
+	Graph g;
+	g.add("A", "B", 2);
+	g.add("B", "C", 3);
+	g.add("A", "C", 10);
+	g.add("C", "D", 1);
+	int calls = 0;
+	vector<WeightChange> seen;
+	int id = g.addWeightListener([&](const vector<WeightChange>& changes) {
+		calls++;
+		seen = changes;
+	});
+
+	cout << isOK(g.updateWeight("A", "C", 4), true) << "update" << endl;
+	cout << isOK(g.getEdgeWeight("A", "C"), 4) << "new weight" << endl;
+	cout << isOK(g.getNumEdges(), 4) << "edge count kept" << endl;
+	cout << isOK(calls, 1) << "listener called" << endl;
+	cout << isOK(seen.size() == 1 && seen[0].start == g.getVertexIndex("A") &&
+		seen[0].end == g.getVertexIndex("C") && seen[0].oldWeight == 10 &&
+		seen[0].newWeight == 4, true) << "change passed" << endl;
+	map<string, int> weight;
+	map<string, string> previous;
+	g.djikstraCostToAllVertices("A", weight, previous);
+	cout << isOK(weight["D"], 5) << "new shortest path" << endl;
+	cout << isOK(previous["C"], "A"s) << "new previous" << endl;
+	cout << isOK(g.updateWeight("C", "A", 1), false) << "no such edge"
+		<< endl;
+	g.updateWeight("A", "C", 4);
+	cout << isOK(calls, 1) << "no call without a change" << endl;
+
+	vector<WeightUpdate> batch = { { "A", "B", 1 }, { "Q", "R", 2 },
+		{ "B", "C", 1 }, { "A", "B", 7 } };
+	cout << isOK(g.updateWeights(batch), 3) << "batch found" << endl;
+	cout << isOK(calls, 2) << "one call per batch" << endl;
+	cout << isOK(static_cast<int>(seen.size()), 3) << "changes in batch"
+		<< endl;
+	cout << isOK(g.getEdgeWeight("A", "B"), 7) << "last update wins" << endl;
+
+	g.updateWeight("C", "D", -2);
+	cout << isOK(g.hasNegativeWeights(), true) << "now negative" << endl;
+	g.updateWeight("C", "D", 1);
+	cout << isOK(g.hasNegativeWeights(), false) << "not negative" << endl;
+	g.removeWeightListener(id);
+	g.updateWeight("C", "D", 6);
+	cout << isOK(calls, 4) << "listener removed" << endl;
+
+	// updates go in the journal too
+	remove("journal_test.checkpoint");
+	remove("journal_test.journal");
+	{
+		Graph journaled;
+		GraphJournal journal("journal_test");
+		journal.recover(journaled);
+		journaled.add("A", "B", 2);
+		journaled.add("B", "C", 3);
+		journaled.updateWeights({ { "A", "B", 8 }, { "B", "C", -5 } });
+	}
+	Graph restarted;
+	GraphJournal journal("journal_test");
+	journal.recover(restarted);
+	cout << isOK(restarted.getEdgeWeight("A", "B"), 8) << "update replayed"
+		<< endl;
+	cout << isOK(restarted.getEdgeWeight("B", "C"), -5) << "negative replayed"
+		<< endl;
+	remove("journal_test.checkpoint");
+	remove("journal_test.journal");
+}
+
+void testGraph28()
+{
+	cout << endl;
+	cout << "test28 - bounded Djikstra" << endl;
+	Graph g;
+	g.add("A", "B", 1);
+	g.add("B", "C", 2);
+	g.add("C", "D", 3);
+	g.add("A", "E", 10);
+	g.add("D", "E", 1);
+	map<string, int> weight;
+	map<string, string> previous;
+
+	SearchLimits radius;
+	radius.maxCost = 3;
+	g.djikstraCostToAllVertices("A", weight, previous, radius);
+	cout << isOK(static_cast<int>(weight.size()), 2) << "within cost 3"
+		<< endl;
+	cout << isOK(weight["C"], 3) << "edge of the radius" << endl;
+	cout << isOK(previous.count("D") == 0, true) << "past the radius"
+		<< endl;
+
+	SearchLimits settled;
+	settled.maxSettled = 3;
+	ShortestPaths paths;
+	g.djikstraCostToAllVertices("A", paths, settled);
+	cout << isOK(paths.getCost("C"), 3) << "third settled" << endl;
+	cout << isOK(paths.isReachable("D"), false) << "not settled"
+		<< endl;
+	cout << isOK(paths.isReachable("E"), false) << "reached not settled"
+		<< endl;
+
+	SearchLimits targets;
+	targets.targets = { "D", "B", "Z" };
+	g.djikstraCostToAllVertices("A", weight, previous, targets);
+	cout << isOK(weight["D"], 6) << "all targets" << endl;
+	cout << isOK(weight.count("E") == 0, true) << "unknown target" << endl;
+	targets.targets = { "D", "B" };
+	g.djikstraCostToAllVertices("A", weight, previous, targets);
+	cout << isOK(static_cast<int>(weight.size()), 3) << "stop at last target"
+		<< endl;
+	targets.anyTarget = true;
+	g.djikstraCostToAllVertices("A", weight, previous, targets);
+	cout << isOK(static_cast<int>(weight.size()), 1) << "nearest target"
+		<< endl;
+	cout << isOK(previous["B"], "A"s) << "path to nearest" << endl;
+
+	// limits pick out exactly the same vertices as the full search
+	Graph grid;
+	GraphGenerator(GraphGenerator::Topology::Grid, 2500, 0, 3).generate(grid);
+	QueryContext context;
+	ShortestPaths full;
+	grid.djikstraCostToAllVertices("v0", full, context);
+	SearchLimits limits;
+	limits.maxCost = full.getCost("v1275") / 2;
+	limits.targets = { "v1275", "v30" };
+	grid.djikstraCostToAllVertices("v0", paths, limits, context);
+	bool same = true;
+	int within = 0;
+	for (int v = 0; v < grid.getNumVertices(); v++)
+	{
+		const string& label = grid.getVertexLabel(v);
+		bool inside = full.getCost(label) <= limits.maxCost;
+		within += inside ? 1 : 0;
+		if (paths.isReachable(label) != inside ||
+			(inside && paths.getCost(label) != full.getCost(label)))
+			same = false;
+	}
+	cout << isOK(same, true) << "radius matches full search" << endl;
+	limits.maxCost = INT_MAX;
+	limits.maxSettled = within;
+	grid.djikstraCostToAllVertices("v0", paths, limits, context);
+	int found = 0;
+	for (int v = 0; v < grid.getNumVertices(); v++)
+		found += paths.isReachable(v) ? 1 : 0;
+	cout << isOK(found, within) << "settle count" << endl;
+	cout << isOK(paths.isReachable("v1275"), false) << "stopped before target"
+		<< endl;
+	limits.maxSettled = INT_MAX;
+	grid.djikstraCostToAllVertices("v0", paths, limits, context);
+	cout << isOK(paths.getCost("v1275"), full.getCost("v1275"))
+		<< "target cost" << endl;
+
+	Graph negative;
+	negative.add("A", "B", -1);
+	bool threw = false;
+	try {
+		negative.djikstraCostToAllVertices("A", weight, previous, radius);
+	}
+	catch (const std::domain_error&) {
+		threw = true;
+	}
+	cout << isOK(threw, true) << "negative weights refused" << endl;
+}
+
 int main() {
 	testGraph0();
 	testGraph1();
@@ -309,5 +1800,28 @@ int main() {
 	testGraph3();
 	testGraph4();
 	testGraph5();
+	testGraph6();
+	testGraph7();
+	testGraph8();
+	testGraph9();
+	testGraph10();
+	testGraph11();
+	testGraph12();
+	testGraph13();
+	testGraph14();
+	testGraph15();
+	testGraph16();
+	testGraph17();
+	testGraph18();
+	testGraph19();
+	testGraph20();
+	testGraph21();
+	testGraph22();
+	testGraph23();
+	testGraph24();
+	testGraph25();
+	testGraph26();
+	testGraph27();
+	testGraph28();
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,292 @@
+//FileName: bench.cpp
+//Benchmarks for the Graph API
+//Date: February 1, 2018
+//
+// bench [maxEdges] [queries] [seed] [topology]
+//   runs every operation on random graphs of 1e3, 1e4, ... maxEdges edges
+//   maxEdges defaults to 1e5, use 10000000 for the full sweep
+//   queries is the number of traversal / Djikstra runs per size
+//   topology is er (default), rmat, grid or chain, see graphgen.h
+// output is one JSON object per line, for example
+//   {"op":"bfs","edges":1000,"vertices":125,"ops":20,"seconds":0.0001,
+//    "ops_per_sec":2e5,"p50_ns":4000,"p90_ns":5000,"p99_ns":6000,
+//    "max_ns":6100,"peak_rss_kb":3500}
+// build on Linux with make bench
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "compressedgraph.h"
+#include "graph.h"
+#include "graphgen.h"
+#include "relaxkernel.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// one random edge
+struct BenchEdge {
+	string from;
+	string to;
+	int weight;
+};
+
+// peak resident set size of this process so far, in kilobytes
+long peakRssKb() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+// nanoseconds between two clock readings
+long long elapsedNs(Clock::time_point from, Clock::time_point to) {
+	return chrono::duration_cast<chrono::nanoseconds>(to - from).count();
+}
+
+// value at fraction p of sorted samples
+long long percentile(const vector<long long>& sorted, double p) {
+	if (sorted.empty())
+		return 0;
+	size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+	return sorted[i];
+}
+
+// print one result line
+// samples are per-operation (or per-batch / batchSize) latencies
+void report(const string& op, long long edges, int vertices, long long ops,
+	long long totalNs, vector<long long> samples) {
+	sort(samples.begin(), samples.end());
+	double seconds = totalNs / 1e9;
+	printf("{\"op\":\"%s\",\"edges\":%lld,\"vertices\":%d,\"ops\":%lld,"
+		"\"seconds\":%.6f,\"ops_per_sec\":%.1f,\"p50_ns\":%lld,"
+		"\"p90_ns\":%lld,\"p99_ns\":%lld,\"max_ns\":%lld,"
+		"\"peak_rss_kb\":%ld}\n",
+		op.c_str(), edges, vertices, ops, seconds,
+		seconds > 0 ? ops / seconds : 0.0,
+		percentile(samples, 0.50), percentile(samples, 0.90),
+		percentile(samples, 0.99), samples.empty() ? 0 : samples.back(),
+		peakRssKb());
+	fflush(stdout);
+}
+
+// generated graph with about 8 edges per vertex
+vector<BenchEdge> randomEdges(long long numEdges,
+	GraphGenerator::Topology topology, unsigned long long seed) {
+	long long numVertices = max(2LL, numEdges / 8);
+	if (topology == GraphGenerator::Topology::Chain)
+		numVertices = numEdges + 1;
+	else if (topology == GraphGenerator::Topology::Grid)
+		numVertices = max(4LL, numEdges / 4);
+	GraphGenerator generator(topology, numVertices, numEdges, seed);
+	generator.setThreads(static_cast<int>(thread::hardware_concurrency()));
+	vector<BenchEdge> edges;
+	edges.reserve(generator.getNumEdges());
+	generator.forEachEdge([&edges](const GeneratedEdge& e) {
+		edges.push_back({ GraphGenerator::label(e.from),
+			GraphGenerator::label(e.to), e.weight });
+	});
+	return edges;
+}
+
+// time fn over count operations, sampling in batches of batchSize
+template <typename Fn>
+void timeOps(const string& op, long long edges, const Graph& g,
+	long long count, long long batchSize, Fn fn) {
+	vector<long long> samples;
+	long long total = 0;
+	for (long long i = 0; i < count; i += batchSize) {
+		long long end = min(count, i + batchSize);
+		Clock::time_point start = Clock::now();
+		for (long long k = i; k < end; ++k)
+			fn(k);
+		long long ns = elapsedNs(start, Clock::now());
+		total += ns;
+		samples.push_back(ns / (end - i));
+	}
+	report(op, edges, g.getNumVertices(), count, total, samples);
+}
+
+void benchSize(long long numEdges, int queries,
+	GraphGenerator::Topology topology, mt19937_64& rng) {
+	vector<BenchEdge> edges = randomEdges(numEdges, topology, rng());
+	numEdges = static_cast<long long>(edges.size());
+	long long batch = max(1LL, numEdges / 1000);
+
+	// add
+	Graph g;
+	timeOps("add", numEdges, g, numEdges, batch, [&](long long i) {
+		g.add(edges[i].from, edges[i].to, edges[i].weight);
+	});
+
+	// footprint of the graph just built
+	GraphMemoryUsage usage = g.memoryUsage();
+	printf("{\"op\":\"memoryUsage\",\"edges\":%lld,\"vertices\":%d,"
+		"\"total_bytes\":%zu,\"vertex_map_bytes\":%zu,"
+		"\"vertex_object_bytes\":%zu,\"label_bytes\":%zu,"
+		"\"adjacency_node_bytes\":%zu,\"edge_payload_bytes\":%zu,"
+		"\"bytes_per_edge\":%.1f}\n",
+		numEdges, g.getNumVertices(), usage.totalBytes(),
+		usage.vertexMapBytes, usage.vertexObjectBytes, usage.labelBytes,
+		usage.adjacencyNodeBytes, usage.edgePayloadBytes,
+		usage.bytesPerEdge());
+
+	// same graph compressed, adjacency bytes against the Graph's
+	{
+		CompressedGraph compressed(g);
+		printf("{\"op\":\"compressedMemory\",\"edges\":%lld,"
+			"\"adjacency_bytes\":%zu,\"graph_adjacency_bytes\":%zu,"
+			"\"total_bytes\":%zu,\"weight_bits\":%d}\n",
+			numEdges, compressed.adjacencyBytes(),
+			usage.adjacencyNodeBytes + usage.edgePayloadBytes,
+			compressed.memoryBytes(), compressed.getWeightBits());
+	}
+
+	// readFile, same edges through the text format
+	string filename = "bench_graph.txt";
+	{
+		ofstream out(filename);
+		out << numEdges << "\n";
+		for (const BenchEdge& e : edges)
+			out << e.from << " " << e.to << " " << e.weight << "\n";
+	}
+	{
+		Graph fromFile;
+		timeOps("readFile", numEdges, fromFile, 1, 1, [&](long long) {
+			fromFile.readFile(filename);
+		});
+	}
+	remove(filename.c_str());
+
+	// a hub, every edge from one vertex in random label order, one add
+	// per edge inserts into the middle of a growing list, addEdges merges
+	{
+		long long hubEdges = min(numEdges, 100000LL);
+		vector<LabeledEdge> hub;
+		for (long long i = 0; i < hubEdges; ++i)
+			hub.push_back(LabeledEdge{ "hub", "h" + to_string(rng()), 1 });
+		Graph oneByOne;
+		timeOps("add_hub", hubEdges, oneByOne, hubEdges, batch,
+			[&](long long i) {
+			oneByOne.add(hub[i].start, hub[i].end, hub[i].weight);
+		});
+		Graph merged;
+		timeOps("addEdges_hub", hubEdges, merged, 1, 1, [&](long long) {
+			merged.addEdges(hub);
+		});
+	}
+
+	// getEdgeWeight on existing edges
+	uniform_int_distribution<long long> pickEdge(0, numEdges - 1);
+	vector<long long> lookups(min(numEdges, 1000000LL));
+	for (long long& l : lookups)
+		l = pickEdge(rng);
+	long long sink = 0;
+	timeOps("getEdgeWeight", numEdges, g, lookups.size(), batch,
+		[&](long long i) {
+		const BenchEdge& e = edges[lookups[i]];
+		sink += g.getEdgeWeight(e.from, e.to);
+	});
+
+	// traversals and Djikstra from random starts, one context reused
+	vector<string> starts;
+	for (int q = 0; q < queries; ++q)
+		starts.push_back(edges[pickEdge(rng)].from);
+	QueryContext context;
+	long long visited = 0;
+	timeOps("depthFirstTraversal", numEdges, g, queries, 1,
+		[&](long long q) {
+		g.depthFirstTraversal(starts[q],
+			[&visited](const TraversalVisit&) { ++visited; }, context);
+	});
+	timeOps("breadthFirstTraversal", numEdges, g, queries, 1,
+		[&](long long q) {
+		g.breadthFirstTraversal(starts[q],
+			[&visited](const TraversalVisit&) { ++visited; }, context);
+	});
+	ShortestPaths paths;
+	timeOps("djikstraCostToAllVertices", numEdges, g, queries, 1,
+		[&](long long q) {
+		g.djikstraCostToAllVertices(starts[q], paths, context);
+	});
+	// a neighborhood query, the 100 vertices nearest each start
+	SearchLimits nearest;
+	nearest.maxSettled = 100;
+	timeOps("djikstraBounded", numEdges, g, queries, 1, [&](long long q) {
+		g.djikstraCostToAllVertices(starts[q], paths, nearest, context);
+	});
+
+	// the same queries with each relaxation kernel the CPU has
+	RelaxKernel best = getRelaxKernel();
+	const char* kernelNames[] = { "djikstra_scalar", "djikstra_avx2",
+		"djikstra_avx512" };
+	for (RelaxKernel kernel :
+		{ RelaxKernel::Scalar, RelaxKernel::Avx2, RelaxKernel::Avx512 })
+	{
+		if (!setRelaxKernel(kernel))
+			continue;
+		timeOps(kernelNames[static_cast<int>(kernel)], numEdges, g, queries,
+			1, [&](long long q) {
+			g.djikstraCostToAllVertices(starts[q], paths, context);
+		});
+	}
+	setRelaxKernel(best);
+
+	// updateWeights, rounds of 5% of the edges like a cost feed
+	const int rounds = 5;
+	vector<vector<WeightUpdate>> feed(rounds);
+	for (int r = 0; r < rounds; ++r)
+		for (long long i = 0; i < max(1LL, numEdges / 20); ++i) {
+			const BenchEdge& e = edges[pickEdge(rng)];
+			feed[r].push_back(WeightUpdate{ e.from, e.to, e.weight + r + 1 });
+		}
+	timeOps("updateWeights", numEdges, g, rounds, 1, [&](long long r) {
+		sink += g.updateWeights(feed[r]);
+	});
+
+	// removeEdge, every edge in random order
+	vector<long long> order(numEdges);
+	for (long long i = 0; i < numEdges; ++i)
+		order[i] = i;
+	shuffle(order.begin(), order.end(), rng);
+	timeOps("removeEdge", numEdges, g, numEdges, batch, [&](long long i) {
+		g.removeEdge(edges[order[i]].from, edges[order[i]].to);
+	});
+
+	if (sink == LLONG_MIN || visited < 0) // keep results alive
+		cerr << "unreachable" << endl;
+}
+
+int main(int argc, char* argv[]) {
+	long long maxEdges = argc > 1 ? atoll(argv[1]) : 100000;
+	int queries = argc > 2 ? atoi(argv[2]) : 20;
+	unsigned long long seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1;
+	string name = argc > 4 ? argv[4] : "er";
+	GraphGenerator::Topology topology = GraphGenerator::Topology::ErdosRenyi;
+	if (name == "rmat")
+		topology = GraphGenerator::Topology::RMat;
+	else if (name == "grid")
+		topology = GraphGenerator::Topology::Grid;
+	else if (name == "chain")
+		topology = GraphGenerator::Topology::Chain;
+	mt19937_64 rng(seed);
+	for (long long edges = 1000; edges <= maxEdges; edges *= 10)
+		benchSize(edges, queries, topology, rng);
+	return 0;
+}
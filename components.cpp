@@ -0,0 +1,130 @@
+// File Name: components.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "components.h"
+#include "graph.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** constructor, no components */
+Components::Components() {}
+
+/** return number of components */
+int Components::getNumComponents() const
+{ return static_cast<int>(sizes.size()); }
+
+/** return the component of a vertex, by index or label
+-1 if the label is not in the graph */
+int Components::getComponent(int vertexIndex) const
+{ return componentOf.at(vertexIndex); }
+
+int Components::getComponent(const std::string& label) const
+{
+	int index = graph == nullptr ? -1 : graph->getVertexIndex(label);
+	return index == -1 ? -1 : componentOf[index];
+}
+
+/** return number of vertices in a component */
+int Components::getSize(int component) const { return sizes.at(component); }
+
+/** flat arrays, component of each vertex index
+and size of each component */
+const std::vector<int>& Components::getComponentOf() const
+{ return componentOf; }
+
+const std::vector<int>& Components::getSizes() const { return sizes; }
+
+/** constructor, empty DAG */
+Condensation::Condensation() : offsets(1, 0) {}
+
+/** return number of components, the vertices of the DAG */
+int Condensation::getNumComponents() const
+{ return static_cast<int>(offsets.size()) - 1; }
+
+/** return number of distinct edges between components */
+int Condensation::getNumEdges() const
+{ return static_cast<int>(targets.size()); }
+
+/** return number of components reached directly from component */
+int Condensation::getOutDegree(int component) const
+{ return offsets.at(component + 1) - offsets.at(component); }
+
+/** return the i-th successor of component, in increasing order */
+int Condensation::getSuccessor(int component, int i) const
+{ return targets.at(offsets.at(component) + i); }
+
+/** numElements singleton sets */
+ConcurrentUnionFind::ConcurrentUnionFind(int numElements)
+	: count(numElements), parent(new std::atomic<int>[numElements])
+{
+	for (int i = 0; i < count; i++)
+		parent[i].store(i, std::memory_order_relaxed);
+}
+
+/** return the root of a's set, halving the path on the way
+safe to call while other threads unite
+a stale grandparent only makes the path a little longer */
+int ConcurrentUnionFind::find(int a)
+{
+	int p = parent[a].load(std::memory_order_relaxed);
+	while (p != a)
+	{
+		int grand = parent[p].load(std::memory_order_relaxed);
+		parent[a].compare_exchange_weak(p, grand,
+			std::memory_order_relaxed);
+		a = p;
+		p = parent[a].load(std::memory_order_relaxed);
+	}
+	return a;
+}
+
+/** merge the sets of a and b, the lower root becomes the root
+safe to call from several threads at once
+linking only to a lower index means no cycles can form */
+void ConcurrentUnionFind::unite(int a, int b)
+{
+	while (true)
+	{
+		a = find(a);
+		b = find(b);
+		if (a == b)
+			return;
+		if (a < b)
+			std::swap(a, b);
+		// a is the higher root, point it at b unless it changed
+		int expected = a;
+		if (parent[a].compare_exchange_strong(expected, b,
+			std::memory_order_acq_rel))
+			return;
+	}
+}
+
+/** number the sets 0.. by lowest element, not thread safe
+fills componentOf and sizes like Components
+the root is the lowest element, so it is seen before the rest */
+void ConcurrentUnionFind::label(std::vector<int>& componentOf,
+	std::vector<int>& sizes)
+{
+	componentOf.assign(count, -1);
+	sizes.clear();
+	for (int i = 0; i < count; i++)
+	{
+		int root = find(i);
+		if (componentOf[root] == -1)
+		{
+			componentOf[root] = static_cast<int>(sizes.size());
+			sizes.push_back(0);
+		}
+		componentOf[i] = componentOf[root];
+		sizes[componentOf[i]]++;
+	}
+}
@@ -0,0 +1,101 @@
+/**
+* Connected component labels for every vertex of a Graph
+* Components are numbered 0 .. getNumComponents() - 1
+*   weakly connected: in order of the lowest vertex index they contain
+*   strongly connected: in topological order of the condensation, so
+*   every edge between components goes from a lower to a higher number
+* Condensation is the DAG with one vertex per strongly connected
+* component and an edge wherever the graph has one between them
+* ConcurrentUnionFind is the lock-free disjoint set used to build
+* weakly connected components from several threads
+*/
+
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Graph;
+
+class Components {
+public:
+	/** constructor, no components */
+	Components();
+
+	/** return number of components */
+	int getNumComponents() const;
+
+	/** return the component of a vertex, by index or label
+	-1 if the label is not in the graph */
+	int getComponent(int vertexIndex) const;
+	int getComponent(const std::string& label) const;
+
+	/** return number of vertices in a component */
+	int getSize(int component) const;
+
+	/** flat arrays, component of each vertex index
+	and size of each component */
+	const std::vector<int>& getComponentOf() const;
+	const std::vector<int>& getSizes() const;
+
+private:
+	friend class Graph;
+
+	/** graph the components came from, used to translate labels */
+	const Graph* graph{ nullptr };
+
+	std::vector<int> componentOf;
+	std::vector<int> sizes;
+};  // end Components
+
+class Condensation {
+public:
+	/** constructor, empty DAG */
+	Condensation();
+
+	/** return number of components, the vertices of the DAG */
+	int getNumComponents() const;
+
+	/** return number of distinct edges between components */
+	int getNumEdges() const;
+
+	/** return number of components reached directly from component */
+	int getOutDegree(int component) const;
+
+	/** return the i-th successor of component, in increasing order */
+	int getSuccessor(int component, int i) const;
+
+private:
+	friend class Graph;
+
+	/** successors of c are targets[offsets[c] .. offsets[c + 1]) */
+	std::vector<int> offsets;
+	std::vector<int> targets;
+};  // end Condensation
+
+class ConcurrentUnionFind {
+public:
+	/** numElements singleton sets */
+	explicit ConcurrentUnionFind(int numElements);
+
+	/** return the root of a's set, halving the path on the way
+	safe to call while other threads unite */
+	int find(int a);
+
+	/** merge the sets of a and b, the lower root becomes the root
+	safe to call from several threads at once */
+	void unite(int a, int b);
+
+	/** number the sets 0.. by lowest element, not thread safe
+	fills componentOf and sizes like Components */
+	void label(std::vector<int>& componentOf, std::vector<int>& sizes);
+
+private:
+	int count;
+	std::unique_ptr<std::atomic<int>[]> parent;
+};  // end ConcurrentUnionFind
+
+#endif  // COMPONENTS_H
@@ -0,0 +1,721 @@
+// File Name: compressedgraph.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <algorithm>
+#include <bitset>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "compressedgraph.h"
+#include "graph.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** first bytes of every file written by writeFile */
+static const char fileMagic[8] = { 'C', 'G', 'R', 'A', 'P', 'H', '1', 0 };
+
+/** constructor, compress all vertices and edges of graph
+the graph's alphabetical neighbor order is increasing id order here,
+so neighbor lists are written as they are without sorting */
+CompressedGraph::CompressedGraph(const Graph& graph)
+{
+	int n = graph.getNumVertices();
+	std::vector<int> order = graph.sortedVertexIndices();
+	std::vector<int> idOf(n);
+	labels.reserve(n);
+	for (int id = 0; id < n; id++)
+	{
+		idOf[order[id]] = id;
+		labels.push_back(graph.vertexList[order[id]]->getLabel());
+	}
+
+	// weight range decides the packed width
+	long long edges = graph.getNumEdges();
+	int maxWeight = INT_MIN;
+	minWeight = INT_MAX;
+	for (int v = 0; v < n; v++)
+		for (const Edge& e : graph.vertexList[v]->getAdjacencyList())
+		{
+			minWeight = std::min(minWeight, e.getWeight());
+			maxWeight = std::max(maxWeight, e.getWeight());
+		}
+	if (edges == 0)
+		minWeight = maxWeight = 0;
+	uint64_t range = static_cast<uint64_t>(
+		static_cast<long long>(maxWeight) - minWeight);
+	while (weightBits < 32 && (range >> weightBits) != 0)
+		weightBits++;
+	weightBuffer.assign(
+		static_cast<size_t>((edges * weightBits + 63) / 64) + 1, 0);
+
+	byteOffsetBuffer.reserve(n + 1);
+	edgeOffsetBuffer.reserve(n + 1);
+	long long edge = 0;
+	for (int id = 0; id < n; id++)
+	{
+		byteOffsetBuffer.push_back(byteBuffer.size());
+		edgeOffsetBuffer.push_back(edge);
+		int last = -1;
+		for (const Edge& e : graph.vertexList[order[id]]->getAdjacencyList())
+		{
+			int to = idOf[e.getEndVertex()];
+			putNeighbor(byteBuffer, id, last, to);
+			last = to;
+			packWeight(weightBuffer, edge, weightBits,
+				static_cast<uint64_t>(
+				static_cast<long long>(e.getWeight()) - minWeight));
+			edge++;
+		}
+	}
+	byteOffsetBuffer.push_back(byteBuffer.size());
+	edgeOffsetBuffer.push_back(edge);
+	byteBuffer.shrink_to_fit();
+
+	byteOffset = byteOffsetBuffer.data();
+	edgeOffset = edgeOffsetBuffer.data();
+	bytes = byteBuffer.data();
+	weights = weightBuffer.data();
+	byteCount = byteBuffer.size();
+	weightWords = weightBuffer.size();
+	valid = true;
+}
+
+/** constructor, map a file saved by writeFile
+advice is applied to the neighbor lists and weights, see isOpen
+the header's sizes and the offsets are checked against the file's
+size before any pointer is set, a bad file leaves an empty graph
+the check reads the offsets once, the neighbor lists are untouched */
+CompressedGraph::CompressedGraph(const std::string& filename,
+	MappedFile::Advice advice) : file(new MappedFile(filename))
+{
+	static const uint64_t empty[1] = { 0 };
+	static const long long zero[1] = { 0 };
+	byteOffset = empty;
+	edgeOffset = zero;
+
+	FileHeader header;
+	if (!file->isOpen() || file->size() < sizeof(header))
+		return;
+	std::memcpy(&header, file->data(), sizeof(header));
+	uint64_t n = header.vertices;
+	uint64_t limit = file->size() / 8; // no part can be bigger
+	if (std::memcmp(header.magic, fileMagic, sizeof(header.magic)) != 0 ||
+		n >= limit || n > INT_MAX || header.weightWords > limit ||
+		header.labelBytes > file->size() || header.byteCount > file->size() ||
+		header.weightBits < 0 || header.weightBits > 32)
+		return;
+	uint64_t labelStart = sizeof(header) + 8 * (2 * (n + 1) +
+		header.weightWords);
+	uint64_t labelText = labelStart + 8 * (n + 1);
+	uint64_t labelEnd = labelText + header.labelBytes;
+	uint64_t byteStart = (labelEnd + 7) / 8 * 8;
+	if (byteStart + header.byteCount != file->size() ||
+		header.weightWords <
+		(header.edges * header.weightBits + 63) / 64 + 1)
+		return;
+
+	const char* base = file->data();
+	const uint64_t* offsets =
+		reinterpret_cast<const uint64_t*>(base + sizeof(header));
+	const uint64_t* edgeOffsets = offsets + n + 1;
+	for (uint64_t v = 0; v <= n; v++)
+	{
+		bool first = v == 0;
+		if ((first && (offsets[0] != 0 || edgeOffsets[0] != 0)) ||
+			(!first && (offsets[v] < offsets[v - 1] ||
+			edgeOffsets[v] < edgeOffsets[v - 1])) ||
+			offsets[v] > header.byteCount || edgeOffsets[v] > header.edges)
+			return;
+	}
+	if (edgeOffsets[n] != header.edges)
+		return;
+
+	const uint64_t* labelOffset =
+		reinterpret_cast<const uint64_t*>(base + labelStart);
+	labels.reserve(static_cast<size_t>(n));
+	for (uint64_t v = 0; v < n; v++)
+	{
+		if (labelOffset[v] > labelOffset[v + 1] ||
+			labelOffset[v + 1] > header.labelBytes)
+		{
+			labels.clear();
+			return;
+		}
+		labels.push_back(std::string(base + labelText + labelOffset[v],
+			labelOffset[v + 1] - labelOffset[v]));
+	}
+	// labels are only read once
+	file->advise(MappedFile::Advice::DontNeed, labelOffset,
+		static_cast<size_t>(labelEnd - labelStart));
+
+	byteOffset = offsets;
+	edgeOffset = reinterpret_cast<const long long*>(offsets + n + 1);
+	weights = offsets + 2 * (n + 1);
+	bytes = reinterpret_cast<const uint8_t*>(base + byteStart);
+	byteCount = static_cast<size_t>(header.byteCount);
+	weightWords = static_cast<size_t>(header.weightWords);
+	minWeight = header.minWeight;
+	weightBits = header.weightBits;
+	valid = true;
+	setAccessPolicy(advice);
+}
+
+/** return false if the file given to the constructor could not be
+mapped or is not a compressed graph, the graph is then empty */
+bool CompressedGraph::isOpen() const { return valid; }
+
+/** return true if the data is in a mapped file */
+bool CompressedGraph::isMapped() const { return file != nullptr; }
+
+/** save to filename, replacing it
+@return true if the whole file was written */
+bool CompressedGraph::writeFile(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+		return false;
+
+	// removed edges are left out by writing a compacted copy
+	Compaction compacted;
+	Rows from = rows();
+	size_t fromBytes = byteCount;
+	size_t fromWords = weightWords;
+	if (tombstoneCount > 0)
+	{
+		compacted.removed = tombstones;
+		rebuild(from, compacted);
+		from.byteOffset = compacted.byteOffset.data();
+		from.edgeOffset = compacted.edgeOffset.data();
+		from.bytes = compacted.bytes.data();
+		from.weights = compacted.weights.data();
+		fromBytes = compacted.bytes.size();
+		fromWords = compacted.weights.size();
+	}
+
+	uint64_t n = labels.size();
+	std::vector<uint64_t> labelOffset(1, 0);
+	for (const std::string& label : labels)
+		labelOffset.push_back(labelOffset.back() + label.size());
+
+	FileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, fileMagic, sizeof(header.magic));
+	header.vertices = n;
+	header.edges = static_cast<uint64_t>(getNumEdges());
+	header.byteCount = fromBytes;
+	header.weightWords = fromWords;
+	header.labelBytes = labelOffset.back();
+	header.minWeight = minWeight;
+	header.weightBits = weightBits;
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(from.byteOffset), 8 * (n + 1));
+	out.write(reinterpret_cast<const char*>(from.edgeOffset), 8 * (n + 1));
+	out.write(reinterpret_cast<const char*>(from.weights), 8 * fromWords);
+	out.write(reinterpret_cast<const char*>(labelOffset.data()),
+		8 * (n + 1));
+	for (const std::string& label : labels)
+		out.write(label.data(), label.size());
+	static const char padding[8] = { 0 };
+	out.write(padding, (8 - labelOffset.back() % 8) % 8);
+	out.write(reinterpret_cast<const char*>(from.bytes), fromBytes);
+	out.close();
+	return !out.fail();
+}
+
+/** hint how the neighbor lists and weights are about to be read,
+does nothing unless mapped, see MappedFile::Advice */
+void CompressedGraph::setAccessPolicy(MappedFile::Advice advice) const
+{
+	if (file == nullptr)
+		return;
+	file->advise(advice, bytes, byteCount);
+	file->advise(advice, weights, 8 * weightWords);
+}
+
+/** breadth-first traversals ask for the neighbor lists of this many
+frontier vertices ahead to be read in before they are reached,
+0 to turn it off, does nothing unless mapped */
+void CompressedGraph::setReadahead(int vertices) { readahead = vertices; }
+
+/** return number of vertices */
+int CompressedGraph::getNumVertices() const
+{ return static_cast<int>(labels.size()); }
+
+/** return number of edges, not counting removed ones */
+long long CompressedGraph::getNumEdges() const
+{ return edgeOffset[labels.size()] - tombstoneCount; }
+
+/** return the id of a vertex, -1 if it does not exist
+ids are 0 to getNumVertices() - 1 in alphabetical order */
+int CompressedGraph::getVertexIndex(const std::string& label) const
+{
+	std::vector<std::string>::const_iterator it =
+		std::lower_bound(labels.begin(), labels.end(), label);
+	if (it == labels.end() || *it != label)
+		return -1;
+	return static_cast<int>(it - labels.begin());
+}
+
+/** return the label of the vertex with the given id */
+const std::string& CompressedGraph::getVertexLabel(int index) const
+{ return labels.at(index); }
+
+/** return the number of neighbors of a vertex */
+int CompressedGraph::getOutDegree(int index) const
+{
+	long long stored = edgeOffset[index + 1] - edgeOffset[index];
+	if (tombstoneCount > 0)
+		stored -= removedBetween(edgeOffset[index], edgeOffset[index + 1]);
+	return static_cast<int>(stored);
+}
+
+/** return weight of the edge between start and end
+returns INT_MAX if not connected, like Graph */
+int CompressedGraph::getEdgeWeight(const std::string& start,
+	const std::string& end) const
+{
+	int from = at(start);
+	int to = getVertexIndex(end);
+	Cursor cursor = neighbors(from);
+	int neighbor;
+	int weight;
+	while (next(cursor, neighbor, weight) && neighbor <= to)
+		if (neighbor == to)
+			return weight;
+	return INT_MAX;
+}
+
+/** return number of bits each weight is packed into */
+int CompressedGraph::getWeightBits() const { return weightBits; }
+
+/** return bytes used by the neighbor lists and weights,
+the compressed equivalent of Graph's adjacency and edge payloads */
+size_t CompressedGraph::adjacencyBytes() const
+{
+	return byteCount + weightWords * sizeof(uint64_t) +
+		(labels.size() + 1) * (sizeof(uint64_t) + sizeof(long long));
+}
+
+/** return all bytes used, including offsets and labels */
+size_t CompressedGraph::memoryBytes() const
+{
+	size_t total = adjacencyBytes() + labels.capacity() * sizeof(std::string) +
+		tombstones.capacity() * sizeof(uint64_t);
+	for (const std::string& label : labels)
+		total += GraphMemoryUsage::stringHeapBytes(label);
+	return total;
+}
+
+/** return a cursor at the start of a vertex's neighbor list */
+CompressedGraph::Cursor CompressedGraph::neighbors(int index) const
+{ return Cursor{ index, -1, byteOffset[index], edgeOffset[index] }; }
+
+/** read the next neighbor and edge weight
+removed edges are still decoded, the gaps run through them
+@return false if the neighbor list is finished */
+bool CompressedGraph::next(Cursor& cursor, int& neighbor, int& weight) const
+{
+	while (cursor.edge != edgeOffset[cursor.vertex + 1])
+	{
+		neighbor = getNeighbor(bytes, cursor.byte, cursor.vertex, cursor.last);
+		cursor.last = neighbor;
+		cursor.edge++;
+		if (tombstoneCount == 0 || !isRemoved(cursor.edge - 1))
+		{
+			weight = getWeight(cursor.edge - 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+/** mark the edge from start to end deleted, see Deleting edges
+a finished background compaction is swapped in first, so the edge
+is looked up in the arrays queries will use
+@return false if there is no such edge */
+bool CompressedGraph::removeEdge(const std::string& start,
+	const std::string& end)
+{
+	if (compaction != nullptr && compaction->done)
+		finishCompaction();
+	int from = at(start);
+	int to = getVertexIndex(end);
+	if (to == -1)
+		return false;
+	Cursor cursor = neighbors(from);
+	int neighbor;
+	int weight;
+	while (next(cursor, neighbor, weight) && neighbor <= to)
+		if (neighbor == to)
+		{
+			long long edge = cursor.edge - 1;
+			if (tombstones.empty())
+				tombstones.assign(
+					static_cast<size_t>(edgeOffset[labels.size()] / 64 + 1), 0);
+			tombstones[edge / 64] |= uint64_t(1) << (edge % 64);
+			tombstoneCount++;
+			compactIfNeeded();
+			return true;
+		}
+	return false;
+}
+
+/** return number of removed edges still stored in the layout */
+long long CompressedGraph::getTombstoneCount() const { return tombstoneCount; }
+
+/** compact once tombstones are this share of the stored edges */
+void CompressedGraph::setCompaction(double threshold, bool background)
+{
+	compactionThreshold = threshold;
+	compactInBackground = background;
+}
+
+/** rebuild the rows that have tombstones now
+waits for a background compaction first, which may leave none */
+void CompressedGraph::compact()
+{
+	finishCompaction();
+	if (tombstoneCount == 0)
+		return;
+	Compaction now;
+	now.removed = tombstones;
+	rebuild(rows(), now);
+	swapIn(now);
+}
+
+/** return true if a background compaction has not been swapped in */
+bool CompressedGraph::isCompacting() const { return compaction != nullptr; }
+
+/** wait for a background compaction and swap its arrays in */
+void CompressedGraph::finishCompaction()
+{
+	if (compaction == nullptr)
+		return;
+	compaction->worker.join();
+	std::unique_ptr<Compaction> finished = std::move(compaction);
+	swapIn(*finished);
+}
+
+/** wait for the worker, the arrays it reads may be going away */
+CompressedGraph::Compaction::~Compaction()
+{
+	if (worker.joinable())
+		worker.join();
+}
+
+/** return the arrays as Rows */
+CompressedGraph::Rows CompressedGraph::rows() const
+{
+	return Rows{ getNumVertices(), byteOffset, edgeOffset, bytes, weights,
+		minWeight, weightBits };
+}
+
+/** build the arrays without the removed edges into out
+a row without removed edges is copied byte for byte, only rows with
+some are decoded and encoded again, every weight moves to its new
+edge number, minWeight and weightBits stay */
+void CompressedGraph::rebuild(const Rows& rows, Compaction& out)
+{
+	const std::vector<uint64_t>& removed = out.removed;
+	auto isGone = [&removed](long long edge) {
+		return (removed[edge / 64] >> (edge % 64)) & 1;
+	};
+	long long stored = rows.edgeOffset[rows.vertices];
+	long long kept = stored;
+	for (size_t w = 0; w < removed.size(); w++)
+		kept -= static_cast<long long>(std::bitset<64>(removed[w]).count());
+	out.byteOffset.reserve(rows.vertices + 1);
+	out.edgeOffset.reserve(rows.vertices + 1);
+	out.weights.assign(
+		static_cast<size_t>((kept * rows.weightBits + 63) / 64) + 1, 0);
+
+	long long edge = 0;
+	for (int v = 0; v < rows.vertices; v++)
+	{
+		out.byteOffset.push_back(out.bytes.size());
+		out.edgeOffset.push_back(edge);
+		long long first = rows.edgeOffset[v];
+		long long last = rows.edgeOffset[v + 1];
+		bool affected = false;
+		for (long long e = first; e < last && !affected; e++)
+			affected = isGone(e) != 0;
+		if (!affected)
+			out.bytes.insert(out.bytes.end(), rows.bytes + rows.byteOffset[v],
+				rows.bytes + rows.byteOffset[v + 1]);
+
+		size_t byte = static_cast<size_t>(rows.byteOffset[v]);
+		int previous = -1; // last neighbor read
+		int written = -1;  // last neighbor kept
+		for (long long e = first; e < last; e++)
+		{
+			if (affected)
+			{
+				previous = getNeighbor(rows.bytes, byte, v, previous);
+				if (isGone(e))
+					continue;
+				putNeighbor(out.bytes, v, written, previous);
+				written = previous;
+			}
+			int weight = unpackWeight(rows.weights, e, rows.weightBits,
+				rows.minWeight);
+			packWeight(out.weights, edge, rows.weightBits,
+				static_cast<uint64_t>(
+				static_cast<long long>(weight) - rows.minWeight));
+			edge++;
+		}
+	}
+	out.byteOffset.push_back(out.bytes.size());
+	out.edgeOffset.push_back(edge);
+	out.bytes.shrink_to_fit();
+	out.done = true;
+}
+
+/** use the arrays of a finished compaction, tombstones set since
+it started are renumbered to match
+edges are numbered in the same order before and after, skipping the
+ones the compaction left out gives each survivor's new number */
+void CompressedGraph::swapIn(Compaction& finished)
+{
+	std::vector<uint64_t> later;
+	long long laterCount = 0;
+	if (tombstoneCount > 0)
+	{
+		long long stored = edgeOffset[labels.size()];
+		long long renumbered = 0;
+		for (long long e = 0; e < stored; e++)
+		{
+			bool gone = (finished.removed[e / 64] >> (e % 64)) & 1;
+			if (gone)
+				continue;
+			if (isRemoved(e))
+			{
+				if (later.empty())
+					later.assign(static_cast<size_t>(
+						finished.edgeOffset.back() / 64 + 1), 0);
+				later[renumbered / 64] |= uint64_t(1) << (renumbered % 64);
+				laterCount++;
+			}
+			renumbered++;
+		}
+	}
+
+	byteOffsetBuffer.swap(finished.byteOffset);
+	edgeOffsetBuffer.swap(finished.edgeOffset);
+	byteBuffer.swap(finished.bytes);
+	weightBuffer.swap(finished.weights);
+	byteOffset = byteOffsetBuffer.data();
+	edgeOffset = edgeOffsetBuffer.data();
+	bytes = byteBuffer.data();
+	weights = weightBuffer.data();
+	byteCount = byteBuffer.size();
+	weightWords = weightBuffer.size();
+	tombstones.swap(later);
+	tombstoneCount = laterCount;
+	file.reset(); // nothing points into the mapping any more
+}
+
+/** start a compaction when tombstones pass the threshold
+a background one copies the tombstones and reads the arrays through
+Rows, which stay put even if the graph is moved */
+void CompressedGraph::compactIfNeeded()
+{
+	long long stored = edgeOffset[labels.size()];
+	if (compaction != nullptr || compactionThreshold <= 0 ||
+		tombstoneCount < compactionThreshold * static_cast<double>(stored))
+		return;
+	if (!compactInBackground)
+	{
+		compact();
+		return;
+	}
+	compaction.reset(new Compaction());
+	compaction->removed = tombstones;
+	Compaction* running = compaction.get();
+	Rows from = rows();
+	compaction->worker = std::thread([running, from]() {
+		rebuild(from, *running);
+	});
+}
+
+/** return true if edge number edge is removed */
+bool CompressedGraph::isRemoved(long long edge) const
+{ return (tombstones[edge / 64] >> (edge % 64)) & 1; }
+
+/** number of removed edges from edge first to edge last - 1 */
+long long CompressedGraph::removedBetween(long long first,
+	long long last) const
+{
+	long long count = 0;
+	for (long long e = first; e < last; e++)
+		count += isRemoved(e) ? 1 : 0;
+	return count;
+}
+
+/** Djikstra, same costs as Graph::djikstraCostToAllVertices and an
+equally short previous vertex, ids are alphabetical so ties may
+pick a different one, the start vertex is not included */
+void CompressedGraph::djikstraCostToAllVertices(const std::string& startLabel,
+	std::map<std::string, int>& weight,
+	std::map<std::string, std::string>& previous) const
+{
+	QueryContext context;
+	djikstraCostToAllVertices(startLabel, weight, previous, context);
+}
+
+/** Djikstra using the caller's context */
+void CompressedGraph::djikstraCostToAllVertices(const std::string& startLabel,
+	std::map<std::string, int>& weight,
+	std::map<std::string, std::string>& previous,
+	QueryContext& context) const
+{
+	weight.clear();
+	previous.clear();
+	auto onSettle = [](int) {};
+	djikstraHelper(at(startLabel), context, onSettle);
+	const std::vector<int>& reached = context.getReached();
+	for (size_t i = 1; i < reached.size(); i++) // reached[0] is the start
+	{
+		int v = reached[i];
+		weight[labels[v]] = context.getDistance(v);
+		previous[labels[v]] = labels[context.getPrevious(v)];
+	}
+}
+
+/** return the id of a vertex, throws std::out_of_range if none */
+int CompressedGraph::at(const std::string& label) const
+{
+	int index = getVertexIndex(label);
+	if (index == -1)
+		throw std::out_of_range("no vertex " + label);
+	return index;
+}
+
+/** ask for the neighbor lists of frontier[from] to frontier[to - 1]
+to be read in
+neighbors of a frontier vertex are usually close to it in id order,
+so the whole range they cover is asked for in one call when it is
+no more than twice the bytes needed, otherwise one call each */
+void CompressedGraph::prefetch(const std::vector<int>& frontier,
+	size_t from, size_t to) const
+{
+	uint64_t low = byteCount;
+	uint64_t high = 0;
+	uint64_t needed = 0;
+	for (size_t i = from; i < to; i++)
+	{
+		int v = frontier[i];
+		low = std::min(low, byteOffset[v]);
+		high = std::max(high, byteOffset[v + 1]);
+		needed += byteOffset[v + 1] - byteOffset[v];
+	}
+	if (needed == 0)
+		return;
+	if (high - low <= 2 * needed)
+		file->advise(MappedFile::Advice::WillNeed, bytes + low,
+			static_cast<size_t>(high - low));
+	else
+		for (size_t i = from; i < to; i++)
+		{
+			int v = frontier[i];
+			file->advise(MappedFile::Advice::WillNeed, bytes + byteOffset[v],
+				static_cast<size_t>(byteOffset[v + 1] - byteOffset[v]));
+		}
+}
+
+/** append value as a varint to out */
+void CompressedGraph::putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+/** read a varint starting at in[byte], move byte past it */
+uint64_t CompressedGraph::getVarint(const uint8_t* in, size_t& byte)
+{
+	uint64_t value = 0;
+	int shift = 0;
+	uint8_t b;
+	do
+	{
+		b = in[byte++];
+		value |= static_cast<uint64_t>(b & 0x7f) << shift;
+		shift += 7;
+	} while (b & 0x80);
+	return value;
+}
+
+/** append neighbor to, after last, of vertex to out
+the first neighbor is a zigzag difference from vertex so near
+neighbors below it are small too, the rest are gaps minus 1 */
+void CompressedGraph::putNeighbor(std::vector<uint8_t>& out, int vertex,
+	int last, int to)
+{
+	if (last == -1)
+	{
+		long long diff = static_cast<long long>(to) - vertex;
+		putVarint(out, diff >= 0 ? 2 * static_cast<uint64_t>(diff) :
+			2 * static_cast<uint64_t>(-diff) - 1);
+	}
+	else
+		putVarint(out, static_cast<uint64_t>(to - last - 1));
+}
+
+/** read the neighbor after last of vertex at in[byte] */
+int CompressedGraph::getNeighbor(const uint8_t* in, size_t& byte,
+	int vertex, int last)
+{
+	uint64_t value = getVarint(in, byte);
+	if (last != -1)
+		return last + 1 + static_cast<int>(value);
+	long long diff = (value & 1) ? -static_cast<long long>(value / 2) - 1 :
+		static_cast<long long>(value / 2);
+	return static_cast<int>(vertex + diff);
+}
+
+/** store value in bits bits as weight number edge
+words must be zeroed and have the spare word at the end */
+void CompressedGraph::packWeight(std::vector<uint64_t>& words,
+	long long edge, int bits, uint64_t value)
+{
+	if (bits == 0)
+		return;
+	uint64_t bit = static_cast<uint64_t>(edge) * bits;
+	words[bit / 64] |= value << (bit % 64);
+	if (bit % 64 + bits > 64)
+		words[bit / 64 + 1] |= value >> (64 - bit % 64);
+}
+
+/** read weight number edge from words, see packWeight
+two words are read when the weight straddles them */
+int CompressedGraph::unpackWeight(const uint64_t* words, long long edge,
+	int bits, int minWeight)
+{
+	if (bits == 0)
+		return minWeight;
+	uint64_t bit = static_cast<uint64_t>(edge) * bits;
+	uint64_t value = words[bit / 64] >> (bit % 64);
+	if (bit % 64 + bits > 64)
+		value |= words[bit / 64 + 1] << (64 - bit % 64);
+	value &= (uint64_t(1) << bits) - 1;
+	return static_cast<int>(static_cast<long long>(value) + minWeight);
+}
+
+/** return the weight of edge number edge */
+int CompressedGraph::getWeight(long long edge) const
+{ return unpackWeight(weights, edge, weightBits, minWeight); }
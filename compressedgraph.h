@@ -0,0 +1,614 @@
+/**
+* Compressed copy of a Graph for graphs too big for memory
+* Built once from a Graph, which can then be deleted
+* Edges can be removed but not added, see Deleting edges
+*
+* Vertex ids are the labels' alphabetical rank, so a vertex's
+* neighbors, already in alphabetical order, are in increasing id order
+* Each neighbor list is stored as varints, 7 bits per byte:
+* the first neighbor as a zigzag difference from the vertex's own id,
+* every later one as the gap from the one before, minus 1
+* Weights are bit packed, each one as weight - minimum weight in just
+* enough bits for the largest, 0 bits if all weights are the same
+*
+* Traversals and Djikstra decode neighbor lists as they go and use a
+* QueryContext like Graph, visitors and sinks are the same too,
+* TraversalVisit::getIndex and SettledVertex::getIndex are the
+* compressed ids, not the Graph's indices
+*
+* writeFile saves it, the filename constructor maps the file back
+* with MappedFile, so neighbor lists and weights stay on disk and are
+* paged in as queries touch them, only the labels are read into memory
+* Opening checks the header and offsets, the neighbor list bytes are
+* trusted, so only map files written by writeFile
+* File layout, native byte order, each part 8 byte aligned:
+*   64 byte header, see FileHeader
+*   byteOffset and edgeOffset, vertices + 1 of each
+*   packed weights, label offsets (vertices + 1), label text
+*   neighbor list bytes
+*
+* Deleting edges:
+* removeEdge only sets the edge's bit in a tombstone bitset, numbered
+* like the packed weights, next skips those edges so every traversal
+* and query does too
+* Once tombstones are a threshold share of the stored edges, compaction
+* rebuilds the layout without them: rows without tombstones are copied
+* byte for byte, only the rows with some are decoded and written again
+* A background compaction reads the arrays on another thread, queries
+* keep running on the old ones, and the next removeEdge or
+* finishCompaction swaps the new arrays in, tombstones set meanwhile
+* are moved over to the new edge numbers
+* A compacted mapped graph keeps its arrays in memory, the file is
+* closed, writeFile always writes the edges without tombstones
+*/
+
+#ifndef COMPRESSEDGRAPH_H
+#define COMPRESSEDGRAPH_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mappedfile.h"
+#include "querycontext.h"
+#include "querycounters.h"
+#include "shortestpaths.h"
+#include "traversal.h"
+
+class Graph;
+
+class CompressedGraph {
+public:
+	/** where a neighbor list is being read from
+	vertex is the list's owner, last the neighbor read most recently */
+	struct Cursor {
+		int vertex;
+		int last;
+		size_t byte;
+		long long edge;
+	};
+
+	/** constructor, compress all vertices and edges of graph */
+	explicit CompressedGraph(const Graph& graph);
+
+	/** constructor, map a file saved by writeFile
+	advice is applied to the neighbor lists and weights, see isOpen */
+	explicit CompressedGraph(const std::string& filename,
+		MappedFile::Advice advice = MappedFile::Advice::Normal);
+
+	/** move only, the data pointers refer to buffers or the mapping
+	a background compaction only reads those, so moving is fine */
+	CompressedGraph(CompressedGraph&&) = default;
+	CompressedGraph(const CompressedGraph&) = delete;
+	CompressedGraph& operator=(const CompressedGraph&) = delete;
+
+	/** return false if the file given to the constructor could not be
+	mapped or is not a compressed graph, the graph is then empty */
+	bool isOpen() const;
+
+	/** return true if the data is in a mapped file */
+	bool isMapped() const;
+
+	/** save to filename, replacing it
+	@return true if the whole file was written */
+	bool writeFile(const std::string& filename) const;
+
+	/** hint how the neighbor lists and weights are about to be read,
+	does nothing unless mapped, see MappedFile::Advice */
+	void setAccessPolicy(MappedFile::Advice advice) const;
+
+	/** breadth-first traversals ask for the neighbor lists of this many
+	frontier vertices ahead to be read in before they are reached,
+	0 to turn it off, does nothing unless mapped */
+	void setReadahead(int vertices);
+
+	/** return number of vertices */
+	int getNumVertices() const;
+
+	/** return number of edges, not counting removed ones */
+	long long getNumEdges() const;
+
+	/** return the id of a vertex, -1 if it does not exist
+	ids are 0 to getNumVertices() - 1 in alphabetical order */
+	int getVertexIndex(const std::string& label) const;
+
+	/** return the label of the vertex with the given id */
+	const std::string& getVertexLabel(int index) const;
+
+	/** return the number of neighbors of a vertex */
+	int getOutDegree(int index) const;
+
+	/** return weight of the edge between start and end
+	returns INT_MAX if not connected, like Graph */
+	int getEdgeWeight(const std::string& start, const std::string& end) const;
+
+	/** return number of bits each weight is packed into */
+	int getWeightBits() const;
+
+	/** mark the edge from start to end deleted, see Deleting edges
+	throws std::out_of_range if start does not exist, like Graph
+	@return false if there is no such edge */
+	bool removeEdge(const std::string& start, const std::string& end);
+
+	/** return number of removed edges still stored in the layout */
+	long long getTombstoneCount() const;
+
+	/** compact once tombstones are this share of the stored edges,
+	default 0.25, 0 never by itself, background runs it on a thread */
+	void setCompaction(double threshold, bool background);
+
+	/** rebuild the rows that have tombstones now
+	waits for a background compaction first */
+	void compact();
+
+	/** return true if a background compaction has not been swapped in */
+	bool isCompacting() const;
+
+	/** wait for a background compaction and swap its arrays in */
+	void finishCompaction();
+
+	/** return bytes used by the neighbor lists and weights,
+	the compressed equivalent of Graph's adjacency and edge payloads
+	when mapped these are file bytes, only some are in memory */
+	size_t adjacencyBytes() const;
+
+	/** return all bytes used, including offsets and labels */
+	size_t memoryBytes() const;
+
+	/** return a cursor at the start of a vertex's neighbor list */
+	Cursor neighbors(int index) const;
+
+	/** read the next neighbor and edge weight
+	@return false if the neighbor list is finished */
+	bool next(Cursor& cursor, int& neighbor, int& weight) const;
+
+	/** call f(neighbor, weight) for every neighbor in id order */
+	template <typename F>
+	void forEachNeighbor(int index, F&& f) const;
+
+	/** depth-first traversal calling any visitor, see traversal.h
+	same order as Graph::depthFirstTraversal */
+	template <typename Visitor>
+	void depthFirstTraversal(const std::string& startLabel,
+		Visitor&& visitor) const;
+
+	/** depth-first traversal using the caller's context */
+	template <typename Visitor>
+	void depthFirstTraversal(const std::string& startLabel,
+		Visitor&& visitor, QueryContext& context) const;
+
+	/** breadth-first traversal calling any visitor, see traversal.h
+	same order as Graph::breadthFirstTraversal */
+	template <typename Visitor>
+	void breadthFirstTraversal(const std::string& startLabel,
+		Visitor&& visitor) const;
+
+	/** breadth-first traversal using the caller's context */
+	template <typename Visitor>
+	void breadthFirstTraversal(const std::string& startLabel,
+		Visitor&& visitor, QueryContext& context) const;
+
+	/** Djikstra, same costs as Graph::djikstraCostToAllVertices and an
+	equally short previous vertex, ids are alphabetical so ties may
+	pick a different one, for graphs without negative weights, there
+	is no Bellman-Ford fallback, throws std::domain_error if any stored
+	weight is negative
+	the start vertex is not included */
+	void djikstraCostToAllVertices(const std::string& startLabel,
+		std::map<std::string, int>& weight,
+		std::map<std::string, std::string>& previous) const;
+
+	/** Djikstra using the caller's context */
+	void djikstraCostToAllVertices(const std::string& startLabel,
+		std::map<std::string, int>& weight,
+		std::map<std::string, std::string>& previous,
+		QueryContext& context) const;
+
+	/** Djikstra streaming each vertex to sink as soon as it is settled
+	see Graph::djikstraStream, throws std::domain_error if any stored
+	weight is negative */
+	template <typename Sink>
+	void djikstraStream(const std::string& startLabel, Sink&& sink) const;
+
+	/** streaming Djikstra using the caller's context */
+	template <typename Sink>
+	void djikstraStream(const std::string& startLabel, Sink&& sink,
+		QueryContext& context) const;
+
+private:
+	/** first 64 bytes of a saved file */
+	struct FileHeader {
+		char magic[8];
+		uint64_t vertices;
+		uint64_t edges;
+		uint64_t byteCount;
+		uint64_t weightWords;
+		uint64_t labelBytes;
+		int32_t minWeight;
+		int32_t weightBits;
+		uint64_t reserved;
+	};
+
+	/** the arrays the edges are read from, what a compaction needs
+	without touching the graph itself */
+	struct Rows {
+		int vertices;
+		const uint64_t* byteOffset;
+		const long long* edgeOffset;
+		const uint8_t* bytes;
+		const uint64_t* weights;
+		int minWeight;
+		int weightBits;
+	};
+
+	/** a compaction, run now or on worker, and the arrays it builds
+	removed is the tombstone bitset it started from */
+	struct Compaction {
+		~Compaction();
+		std::thread worker;
+		std::atomic<bool> done{ false };
+		std::vector<uint64_t> removed;
+		std::vector<uint64_t> byteOffset;
+		std::vector<long long> edgeOffset;
+		std::vector<uint8_t> bytes;
+		std::vector<uint64_t> weights;
+	};
+
+	/** return the arrays as Rows */
+	Rows rows() const;
+
+	/** build the arrays without the removed edges into out */
+	static void rebuild(const Rows& rows, Compaction& out);
+
+	/** use the arrays of a finished compaction, tombstones set since
+	it started are renumbered to match */
+	void swapIn(Compaction& finished);
+
+	/** start a compaction when tombstones pass the threshold */
+	void compactIfNeeded();
+
+	/** return true if edge number edge is removed */
+	bool isRemoved(long long edge) const;
+
+	/** number of removed edges from edge first to edge last - 1 */
+	long long removedBetween(long long first, long long last) const;
+
+	/** ask for the neighbor lists of frontier[from] to frontier[to - 1]
+	to be read in */
+	void prefetch(const std::vector<int>& frontier, size_t from,
+		size_t to) const;
+
+	/** return the id of a vertex, throws std::out_of_range if none */
+	int at(const std::string& label) const;
+
+	/** append value as a varint to out */
+	static void putVarint(std::vector<uint8_t>& out, uint64_t value);
+
+	/** read a varint starting at in[byte], move byte past it */
+	static uint64_t getVarint(const uint8_t* in, size_t& byte);
+
+	/** append neighbor to, after last, of vertex to out */
+	static void putNeighbor(std::vector<uint8_t>& out, int vertex,
+		int last, int to);
+
+	/** read the neighbor after last of vertex at in[byte] */
+	static int getNeighbor(const uint8_t* in, size_t& byte, int vertex,
+		int last);
+
+	/** store value in bits bits as weight number edge */
+	static void packWeight(std::vector<uint64_t>& words, long long edge,
+		int bits, uint64_t value);
+
+	/** read weight number edge from words, see packWeight */
+	static int unpackWeight(const uint64_t* words, long long edge,
+		int bits, int minWeight);
+
+	/** return the weight of edge number edge */
+	int getWeight(long long edge) const;
+
+	/** helper for both Djikstra entry points, see Graph::djikstraHelper */
+	template <typename OnSettle>
+	void djikstraHelper(int start, QueryContext& context,
+		OnSettle& onSettle) const;
+
+	/** helper for depthFirstTraversal */
+	template <typename Visitor>
+	void depthFirstTraversalHelper(int start, Visitor& visitor,
+		QueryContext& context) const;
+
+	/** helper for breadthFirstTraversal */
+	template <typename Visitor>
+	void breadthFirstTraversalHelper(int start, Visitor& visitor,
+		QueryContext& context) const;
+
+	/** labels in id order, which is alphabetical */
+	std::vector<std::string> labels;
+
+	/** neighbor list of vertex v starts at bytes[byteOffset[v]],
+	one extra entry at the end */
+	const uint64_t* byteOffset{ nullptr };
+
+	/** edges of vertex v are numbered edgeOffset[v] to
+	edgeOffset[v + 1] - 1, this numbers the packed weights */
+	const long long* edgeOffset{ nullptr };
+
+	/** varint encoded neighbor lists */
+	const uint8_t* bytes{ nullptr };
+
+	/** packed weights, one spare word so reads never run off the end */
+	const uint64_t* weights{ nullptr };
+
+	/** sizes of bytes and weights */
+	size_t byteCount{ 0 };
+	size_t weightWords{ 0 };
+
+	/** weight stored as weight - minWeight in weightBits bits */
+	int minWeight{ 0 };
+	int weightBits{ 0 };
+
+	/** frontier vertices read ahead by breadth-first traversals */
+	int readahead{ 0 };
+
+	/** false if a file could not be opened */
+	bool valid{ false };
+
+	/** what the pointers above point into, built from a Graph */
+	std::vector<uint64_t> byteOffsetBuffer;
+	std::vector<long long> edgeOffsetBuffer;
+	std::vector<uint8_t> byteBuffer;
+	std::vector<uint64_t> weightBuffer;
+
+	/** or opened from a file */
+	std::unique_ptr<MappedFile> file;
+
+	/** one bit per stored edge, set if removed, empty until the first
+	removeEdge */
+	std::vector<uint64_t> tombstones;
+	long long tombstoneCount{ 0 };
+
+	/** set by setCompaction */
+	double compactionThreshold{ 0.25 };
+	bool compactInBackground{ false };
+
+	/** compaction running in the background, nullptr if none */
+	std::unique_ptr<Compaction> compaction;
+};  // end CompressedGraph
+
+/** call f(neighbor, weight) for every neighbor in id order */
+template <typename F>
+void CompressedGraph::forEachNeighbor(int index, F&& f) const
+{
+	Cursor cursor = neighbors(index);
+	int neighbor;
+	int weight;
+	while (next(cursor, neighbor, weight))
+		f(neighbor, weight);
+}
+
+/** depth-first traversal calling any visitor, see traversal.h */
+template <typename Visitor>
+void CompressedGraph::depthFirstTraversal(const std::string& startLabel,
+	Visitor&& visitor) const
+{
+	QueryContext context;
+	depthFirstTraversalHelper(at(startLabel), visitor, context);
+}
+
+/** depth-first traversal using the caller's context */
+template <typename Visitor>
+void CompressedGraph::depthFirstTraversal(const std::string& startLabel,
+	Visitor&& visitor, QueryContext& context) const
+{
+	depthFirstTraversalHelper(at(startLabel), visitor, context);
+}
+
+/** breadth-first traversal calling any visitor, see traversal.h */
+template <typename Visitor>
+void CompressedGraph::breadthFirstTraversal(const std::string& startLabel,
+	Visitor&& visitor) const
+{
+	QueryContext context;
+	breadthFirstTraversalHelper(at(startLabel), visitor, context);
+}
+
+/** breadth-first traversal using the caller's context */
+template <typename Visitor>
+void CompressedGraph::breadthFirstTraversal(const std::string& startLabel,
+	Visitor&& visitor, QueryContext& context) const
+{
+	breadthFirstTraversalHelper(at(startLabel), visitor, context);
+}
+
+/** Djikstra streaming each vertex to sink as soon as it is settled */
+template <typename Sink>
+void CompressedGraph::djikstraStream(const std::string& startLabel,
+	Sink&& sink) const
+{
+	QueryContext context;
+	djikstraStream(startLabel, sink, context);
+}
+
+/** streaming Djikstra using the caller's context */
+template <typename Sink>
+void CompressedGraph::djikstraStream(const std::string& startLabel,
+	Sink&& sink, QueryContext& context) const
+{
+	auto onSettle = [this, &sink, &context](int v) {
+		int prev = context.getPrevious(v);
+		sink(SettledVertex(v, labels[v], context.getDistance(v), prev,
+			prev == -1 ? nullptr : &labels[prev]));
+	};
+	djikstraHelper(at(startLabel), context, onSettle);
+}
+
+/** helper for both Djikstra entry points, see Graph::djikstraHelper
+neighbors are decoded straight into the relaxation loop
+minWeight is the lowest stored weight, so a negative one means
+Djikstra could be wrong */
+template <typename OnSettle>
+void CompressedGraph::djikstraHelper(int start, QueryContext& context,
+	OnSettle& onSettle) const
+{
+	if (minWeight < 0)
+		throw std::domain_error("Djikstra needs non-negative weights");
+	std::vector<QueryContext::HeapEntry>& pq = context.getHeap();
+	std::greater<QueryContext::HeapEntry> order; // lowest cost on top
+	context.beginQuery(getNumVertices());
+
+	QueryCounters& counters = context.getCounters();
+	context.setDistance(start, 0, -1);
+	pq.push_back(QueryContext::HeapEntry(0, start));
+	GRAPH_COUNT(counters, heapPushes, 1);
+	while (!pq.empty())
+	{
+		std::pop_heap(pq.begin(), pq.end(), order);
+		int v = pq.back().second;
+		int vCost = pq.back().first;
+		pq.pop_back();
+		if (context.isSettled(v) || vCost > context.getDistance(v))
+		{
+			GRAPH_COUNT(counters, stalePops, 1);
+			continue; // stale entry, a cheaper one was already used
+		}
+		context.settle(v);
+		GRAPH_COUNT(counters, verticesSettled, 1);
+		onSettle(v);
+
+		Cursor cursor = neighbors(v);
+		int u;
+		int weight;
+		while (next(cursor, u, weight))
+		{
+			GRAPH_COUNT(counters, edgesRelaxed, 1);
+			if (context.isSettled(u))
+				continue;
+			int cost = vCost + weight;
+			if (!context.isReached(u) || cost < context.getDistance(u))
+			{
+				context.setDistance(u, cost, v);
+				pq.push_back(QueryContext::HeapEntry(cost, u));
+				std::push_heap(pq.begin(), pq.end(), order);
+				GRAPH_COUNT(counters, heapPushes, 1);
+				GRAPH_COUNT_MAX(counters, frontierHighWater,
+					static_cast<long long>(pq.size()));
+			}
+		}
+	}
+}
+
+/** helper for depthFirstTraversal
+the stack holds a Cursor per vertex, where its neighbor list was left
+QueryContext's stack holds Graph iterators, so this one is local */
+template <typename Visitor>
+void CompressedGraph::depthFirstTraversalHelper(int start, Visitor& visitor,
+	QueryContext& context) const
+{
+	std::vector<Cursor> mystack;
+	QueryCounters& counters = context.getCounters();
+	context.beginQuery(getNumVertices());
+
+	context.visit(start);
+	TraversalControl control = callVisitor(visitor,
+		TraversalVisit(start, labels[start], 0));
+	if (control == TraversalControl::Continue)
+		mystack.push_back(neighbors(start));
+
+	while (!mystack.empty() && control != TraversalControl::Stop)
+	{
+		//find unvisited neighbor, cursor remembers where we stopped
+		int neighbor = -1;
+		int next;
+		int weight;
+		while (this->next(mystack.back(), next, weight))
+		{
+			if (!context.isVisited(next))
+			{
+				neighbor = next;
+				break;
+			}
+		}
+
+		if (neighbor != -1)
+		{
+			context.visit(neighbor);
+			control = callVisitor(visitor, TraversalVisit(neighbor,
+				labels[neighbor], static_cast<int>(mystack.size())));
+			if (control == TraversalControl::Continue)
+			{
+				mystack.push_back(neighbors(neighbor));
+				GRAPH_COUNT_MAX(counters, frontierHighWater,
+					static_cast<long long>(mystack.size()));
+			}
+		}
+		else
+			mystack.pop_back();
+	}
+}
+
+/** helper for breadthFirstTraversal, see Graph's for the level tracking
+when mapped with a readahead the frontier's neighbor lists are asked
+for a window ahead of where they are read */
+template <typename Visitor>
+void CompressedGraph::breadthFirstTraversalHelper(int start,
+	Visitor& visitor, QueryContext& context) const
+{
+	std::vector<int>& myqueue = context.getFrontier();
+	QueryCounters& counters = context.getCounters();
+	context.beginQuery(getNumVertices());
+
+	context.visit(start);
+	TraversalControl control = callVisitor(visitor,
+		TraversalVisit(start, labels[start], 0));
+	if (control == TraversalControl::Continue)
+		myqueue.push_back(start);
+
+	size_t levelEnd = myqueue.size();
+	size_t prefetched = 0; // frontier[0 .. prefetched - 1] asked for
+	int depth = 0;
+	for (size_t head = 0; head < myqueue.size(); head++)
+	{
+		if (head == levelEnd)
+		{
+			depth++;
+			levelEnd = myqueue.size();
+		}
+		if (file != nullptr && readahead > 0 && prefetched <= head)
+		{
+			// ask for a window at a time, not one call per vertex
+			prefetched = std::min(myqueue.size(),
+				head + static_cast<size_t>(readahead));
+			prefetch(myqueue, head, prefetched);
+		}
+		Cursor cursor = neighbors(myqueue[head]);
+		int neighbor;
+		int weight;
+		while (next(cursor, neighbor, weight))
+		{
+			if (context.isVisited(neighbor))
+				continue;
+			context.visit(neighbor);
+			control = callVisitor(visitor, TraversalVisit(
+				neighbor, labels[neighbor], depth + 1));
+			if (control == TraversalControl::Stop)
+				break;
+			if (control == TraversalControl::Continue)
+			{
+				myqueue.push_back(neighbor);
+				GRAPH_COUNT_MAX(counters, frontierHighWater,
+					static_cast<long long>(myqueue.size() - head));
+			}
+		}
+		if (control == TraversalControl::Stop)
+			break;
+	}
+}
+
+#endif  // COMPRESSEDGRAPH_H
@@ -2,7 +2,6 @@
 // Class Method Programmer: Tabitha Roemish
 // Date: 2/14/2017
 
-#include <string>
 #include "edge.h"
 
 
@@ -13,15 +12,18 @@
 
 Edge::Edge() {}
 
-/** constructor with label and weight */
-Edge::Edge(const std::string& end, int weight) 
+/** constructor with end vertex index and weight */
+Edge::Edge(int end, int weight) 
 {
 	endVertex = end;
 	edgeWeight = weight;
 }
 
-/** return the vertex this edge connects to */
-std::string Edge::getEndVertex() const { return endVertex; }
+/** return the index of the vertex this edge connects to */
+int Edge::getEndVertex() const { return endVertex; }
 
 /** return the weight/cost of travlleing via this edge */
-int Edge::getWeight() const { return edgeWeight; }
\ No newline at end of file
+int Edge::getWeight() const { return edgeWeight; }
+
+/** change the weight, the end vertex stays */
+void Edge::setWeight(int weight) { edgeWeight = weight; }
@@ -1,35 +1,39 @@
 /**
 * Used by vertex to keep track of all the vertices connects to
 * Each edge has a weight, possibly 0
+* The end vertex is kept as its index in the graph, 8 bytes per edge,
+* Graph::getVertexLabel turns it back into a label when needed
 * Edge is a simple container class, no interesting functions
 */
 
 #ifndef EDGE_H
 #define EDGE_H
 
-#include <string>
-
 class Edge {
 public:
 	/** empty edge constructor */
 	Edge();
 
-	/** constructor with label and weight */
-	Edge(const std::string& end, int weight);
+	/** constructor with end vertex index and weight */
+	Edge(int end, int weight);
 
-	/** return the vertex this edge connects to */
-	std::string getEndVertex() const;
+	/** return the index of the vertex this edge connects to */
+	int getEndVertex() const;
 
 	/** return the weight/cost of travlleing via this edge */
 	int getWeight() const;
 
+	/** change the weight, the end vertex stays */
+	void setWeight(int weight);
+
 private:
-	/** end vertex, cannot be changed */
-	std::string endVertex{ "" };
+	/** end vertex index, cannot be changed */
+	int endVertex{ -1 };
 
-	/** edge weight, cannot be changed */
+	/** edge weight, changed only by Graph::updateWeight */
 	int edgeWeight{ 0 };
 };  //  end Edge
 
+static_assert(sizeof(Edge) == 8, "Edge should be two ints");
 
 #endif  // EDGE_H
@@ -0,0 +1,112 @@
+// File Name: edgelogfollower.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "edgelogfollower.h"
+#include "graph.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** bytes read from the log at a time */
+static const size_t chunkSize = 1 << 16;
+
+/** follow filename starting at a byte offset
+offset 0 reads the count line first, any other offset must be the
+start of a line, such as a saved getOffset */
+EdgeLogFollower::EdgeLogFollower(const std::string& filename,
+	long long offset)
+	: filename(filename), offset(offset < 0 ? 0 : offset) {}
+
+/** read the lines appended since the last poll and apply them
+reads in chunks from the offset to the end of the file, a line split
+between chunks is carried over, one cut off by the end of the file is
+not applied and the offset stays at its start */
+EdgeLogFollower::Batch EdgeLogFollower::poll(Graph& graph)
+{
+	Batch batch;
+	std::ifstream log(filename, std::ios::in | std::ios::binary);
+	if (!log.is_open())
+		return batch;
+	log.seekg(0, std::ios::end);
+	long long size = static_cast<long long>(log.tellg());
+	if (size < offset)
+	{
+		batch.truncated = true;
+		return batch;
+	}
+	log.seekg(offset);
+
+	bool countLine = offset == 0; // readFile skips it too
+	std::vector<char> chunk(chunkSize);
+	std::string line;
+	while (log.read(chunk.data(), chunk.size()) || log.gcount() > 0)
+	{
+		size_t got = static_cast<size_t>(log.gcount());
+		size_t lineStart = 0;
+		for (size_t i = 0; i < got; i++)
+		{
+			if (chunk[i] != '\n')
+				continue;
+			line.append(chunk.data() + lineStart, i - lineStart);
+			offset += static_cast<long long>(line.size()) + 1;
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if (countLine)
+				countLine = false;
+			else
+				applyLine(line, graph, batch);
+			line.clear();
+			lineStart = i + 1;
+		}
+		line.append(chunk.data() + lineStart, got - lineStart);
+	}
+	return batch;
+}
+
+/** return the byte offset just after the last complete line */
+long long EdgeLogFollower::getOffset() const { return offset; }
+
+/** return the name of the log */
+const std::string& EdgeLogFollower::getFilename() const { return filename; }
+
+/** apply one complete line, without its newline
+blank lines are ignored, an add needs a weight like readFile expects,
+a delete of an edge that is not there changes nothing */
+void EdgeLogFollower::applyLine(const std::string& line, Graph& graph,
+	Batch& batch)
+{
+	std::istringstream ss(line);
+	std::string first;
+	if (!(ss >> first))
+		return;
+
+	std::string startVertex;
+	std::string endVertex;
+	if (first == "-")
+	{
+		if (!(ss >> startVertex >> endVertex) ||
+			graph.getVertexIndex(startVertex) == -1 ||
+			!graph.removeEdge(startVertex, endVertex))
+			batch.skipped++;
+		else
+			batch.removed++;
+		return;
+	}
+
+	int weight = 0;
+	startVertex = first;
+	if (!(ss >> endVertex >> weight) ||
+		!graph.add(startVertex, endVertex, weight))
+		batch.skipped++;
+	else
+		batch.added++;
+}
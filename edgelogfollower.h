@@ -0,0 +1,65 @@
+/**
+* Incremental ingestion of an append-only edge log into a Graph
+* The log is in the readFile format, its first line is the edge count
+* and each later line adds an edge:
+*   fromVertex  toVertex  edgeWeight
+* A line starting with "-" retracts an edge:
+*   -  fromVertex  toVertex
+*
+* Each poll reads only the bytes appended since the last one and
+* applies the complete lines with Graph::add and Graph::removeEdge
+* A last line without its newline is left in the file until the rest
+* of it is written, so a writer caught mid-line is never misread
+* getOffset is where the next poll starts, saving it lets a restarted
+* process resume without reading the log again
+* The graph has no locking, poll between queries, not during them
+*/
+
+#ifndef EDGELOGFOLLOWER_H
+#define EDGELOGFOLLOWER_H
+
+#include <string>
+
+class Graph;
+
+class EdgeLogFollower {
+public:
+	/** what one poll applied */
+	struct Batch {
+		/** lines that added an edge */
+		int added{ 0 };
+		/** delete records that removed an edge */
+		int removed{ 0 };
+		/** edges already there, deletes of missing edges and lines
+		that do not parse */
+		int skipped{ 0 };
+		/** the log is shorter than the offset, so it was replaced
+		rather than appended to, nothing was read */
+		bool truncated{ false };
+	};
+
+	/** follow filename starting at a byte offset
+	offset 0 reads the count line first, any other offset must be the
+	start of a line, such as a saved getOffset */
+	explicit EdgeLogFollower(const std::string& filename,
+		long long offset = 0);
+
+	/** read the lines appended since the last poll and apply them
+	a missing file is not an error, there is nothing to read yet */
+	Batch poll(Graph& graph);
+
+	/** return the byte offset just after the last complete line */
+	long long getOffset() const;
+
+	/** return the name of the log */
+	const std::string& getFilename() const;
+
+private:
+	/** apply one complete line, without its newline */
+	void applyLine(const std::string& line, Graph& graph, Batch& batch);
+
+	std::string filename;
+	long long offset;
+};  // end EdgeLogFollower
+
+#endif  // EDGELOGFOLLOWER_H
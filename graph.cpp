@@ -2,16 +2,24 @@
 // Class Method Programmer: Tabitha Roemish
 // Date: 2/14/2017
 
-#include <queue>
+#include <algorithm>
+#include <atomic>
 #include <climits>
-#include <set>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <map>
-#include <stack>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "graph.h"
+#include "graphjournal.h"
 
 /**
 * A graph is made up of vertices and edges
@@ -33,15 +41,17 @@ Graph::Graph()
 }                                                         
 
 /** destructor, delete all vertices and edges
-only vertices stored in map
+only vertices stored in vertexList
 no pointers to edges created by graph */
 Graph::~Graph() 
 { 
+	if (journal != nullptr)
+		journal->detach();
 	// go through graph verticies and delete
-	for (std::map<std::string, Vertex*>::iterator it = vertices.begin(),
-		it_end = vertices.end(); it != it_end; it++)
+	for (std::vector<Vertex*>::iterator it = vertexList.begin(),
+		it_end = vertexList.end(); it != it_end; it++)
 	{
-		delete it->second;
+		delete *it;
 	}
 }																	
 
@@ -55,26 +65,102 @@ int Graph::getNumEdges() const { return numberOfEdges; }
 if the vertices do not exist, create them
 calls Vertex::connect
 a vertex cannot connect to itself
-or have multiple edges to another vertex */
+or have multiple edges to another vertex
+the edge is inserted into a sorted list, O(degree) moves, so
+building a hub one add at a time is O(degree^2), use addEdges or
+readFile for bulk loads */
 bool Graph::add(std::string start, std::string end, int edgeWeight) 
 { 
-	findOrCreateVertex(end);
+	int firstNew = numberOfVertices;
+	Vertex * endVertex = findOrCreateVertex(end);
 	Vertex * temp = findOrCreateVertex(start);
 	
-	if ((temp->connect(end, edgeWeight)))
+	if ((temp->connect(*endVertex, edgeWeight, vertexList)))
 	{
 		numberOfEdges++;
+		if (edgeWeight < 0)
+			negativeEdges++;
+		edgesChanged();
+		if (journal != nullptr)
+			journal->recordAdd(temp->getIndex(), endVertex->getIndex(),
+				edgeWeight, firstNew);
 		return true;
 	}
 	else
+	{
+		// new vertices are recorded too, replay must create them
+		if (journal != nullptr && numberOfVertices != firstNew)
+			journal->recordAdd(temp->getIndex(), endVertex->getIndex(),
+				edgeWeight, firstNew);
 		return false; 
+	}
 }																					
 
+/** return an estimate of the memory used by this graph
+broken down by vertex map, vertices, labels, adjacency and edges
+each adjacency list is one heap block, its unused capacity and
+malloc rounding count as adjacency overhead */
+GraphMemoryUsage Graph::memoryUsage() const
+{
+	GraphMemoryUsage usage;
+	usage.vertices = numberOfVertices;
+	usage.edges = numberOfEdges;
+	usage.vertexMapBytes = vertices.memoryBytes();
+	usage.vertexObjectBytes = vertexList.capacity() * sizeof(Vertex*);
+
+	for (size_t v = 0; v < vertexList.size(); v++)
+	{
+		const Vertex* vertex = vertexList[v];
+		usage.vertexObjectBytes += GraphMemoryUsage::heapBlock(sizeof(Vertex));
+		usage.labelBytes +=
+			GraphMemoryUsage::stringHeapBytes(vertex->getLabel());
+
+		const Vertex::AdjacencyList& edges = vertex->getAdjacencyList();
+		size_t payload = edges.size() * sizeof(Edge);
+		if (edges.capacity() > 0)
+			usage.adjacencyNodeBytes += GraphMemoryUsage::heapBlock(
+				edges.capacity() * sizeof(Edge)) - payload;
+		usage.edgePayloadBytes += payload;
+	}
+	return usage;
+}
+
+/** return the index of a vertex, -1 if it does not exist
+indices run from 0 to getNumVertices() - 1 in creation order */
+int Graph::getVertexIndex(const std::string& label) const
+{
+	const Vertex* vertex = findVertex(label);
+	return vertex == nullptr ? -1 : vertex->getIndex();
+}
+
+/** return the label of the vertex with the given index */
+const std::string& Graph::getVertexLabel(int index) const
+{ return vertexList.at(index)->getLabel(); }
+
+/** return every vertex index, in alphabetical order of the labels
+the lookup table is unordered, use this where order matters */
+std::vector<int> Graph::sortedVertexIndices() const
+{
+	std::vector<int> order(numberOfVertices);
+	for (int v = 0; v < numberOfVertices; v++)
+		order[v] = v;
+	std::sort(order.begin(), order.end(), [this](int a, int b) {
+		return vertexList[a]->getLabel() < vertexList[b]->getLabel();
+	});
+	return order;
+}
+
 /** return weight of the edge between start and end
-returns INT_MAX if not connected or vertices don't exist */
+returns INT_MAX if not connected or vertices don't exist,
+-1 is a weight like any other
+throws std::out_of_range if start is not in the graph */
 int Graph::getEdgeWeight(std::string start, std::string end) const 
 { 
-	return vertices.at(start)->getEdgeWeight(end);
+	const Vertex* startVertex = vertices.at(start);
+	const Vertex* endVertex = findVertex(end);
+	if (endVertex == nullptr)
+		return INT_MAX;
+	return startVertex->getEdgeWeight(*endVertex, vertexList);
 } 
 
 /** read edges from file
@@ -90,6 +176,7 @@ void Graph::readFile(std::string filename)
 	std::string startVertex = " ";
 	std::string endVertex = " ";
 	std::stringstream ss;
+	std::vector<BatchEdge> batch;
 
 	if (toRead.is_open())
 	{
@@ -100,7 +187,18 @@ void Graph::readFile(std::string filename)
 			ss << parse;
 			ss >> startVertex >> endVertex >> weight;
 
-			add(startVertex, endVertex, weight);
+			// the journal records every add, so it gets them one by one
+			if (journal != nullptr)
+				add(startVertex, endVertex, weight);
+			else
+			{
+				int end = findOrCreateVertex(endVertex)->getIndex();
+				int start = findOrCreateVertex(startVertex)->getIndex();
+				batch.push_back(BatchEdge(start, Edge(end, weight)));
+				if (batch.size() >= std::max(minBatch,
+					static_cast<size_t>(numberOfEdges) / 2))
+					connectBatch(batch);
+			}
 
 			//reset
 			startVertex = " ";
@@ -111,89 +209,854 @@ void Graph::readFile(std::string filename)
 	}
 	else
 		std::cerr << "Could not open file: " << filename;
+	connectBatch(batch);
 	
 	toRead.close();
 	
 }	
 
+/** add many edges, like add for each in order, vertices get the
+same indices, but each adjacency list is merged once instead of
+one sorted insert per edge
+the batch grows with the graph like readFile's
+@return  number of edges added */
+int Graph::addEdges(const std::vector<LabeledEdge>& edges)
+{
+	int added = 0;
+	std::vector<BatchEdge> batch;
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		if (journal != nullptr)
+		{
+			added += add(edges[i].start, edges[i].end, edges[i].weight) ?
+				1 : 0;
+			continue;
+		}
+		int end = findOrCreateVertex(edges[i].end)->getIndex();
+		int start = findOrCreateVertex(edges[i].start)->getIndex();
+		batch.push_back(BatchEdge(start, Edge(end, edges[i].weight)));
+		if (batch.size() >= std::max(minBatch,
+			static_cast<size_t>(numberOfEdges) / 2))
+			added += connectBatch(batch);
+	}
+	return added + connectBatch(batch);
+}
+
 /** depth-first traversal starting from startLabel
-call the function visit on each vertex label */
+call the function visit on each vertex label
+uses a temporary QueryContext, the graph is not modified */
 void Graph::depthFirstTraversal(std::string startLabel,
-	void visit(const std::string&)) 
+	void visit(const std::string&)) const
 {
-	std::stack<Vertex> mystack;
-	std::string current = " ";
-	this->unvisitVertices();
+	QueryContext context;
+	depthFirstTraversal(startLabel, visit, context);
+}
 
-	mystack.push(*(vertices.at(startLabel)));
-	visit(vertices.at(startLabel)->getLabel());
-	vertices.at(startLabel)->visit();
+/** depth-first traversal using the caller's context
+one context per thread lets traversals run concurrently */
+void Graph::depthFirstTraversal(std::string startLabel,
+	void visit(const std::string&), QueryContext& context) const
+{
+	depthFirstTraversalHelper(vertices.at(startLabel), visit, context);
+}    
 
-	while (!mystack.empty())
-	{
-		//find unvisited neighbor
-		current = findUnvisitedNeighbor(mystack.top().getLabel());
-		
-		if (!(vertices.at(current)->isVisited()))
+/** breadth-first traversal starting from startLabel
+call the function visit on each vertex label
+uses a temporary QueryContext, the graph is not modified */
+void Graph::breadthFirstTraversal(std::string startLabel,      
+	void visit(const std::string&)) const
+{
+	QueryContext context;
+	breadthFirstTraversal(startLabel, visit, context);
+}
+
+/** breadth-first traversal using the caller's context
+one context per thread lets traversals run concurrently */
+void Graph::breadthFirstTraversal(std::string startLabel,
+	void visit(const std::string&), QueryContext& context) const
+{
+	breadthFirstTraversalHelper(vertices.at(startLabel), visit, context);
+}
+
+/** work done by every finished query on this graph so far
+see querycounters.h, all 0 unless built with GRAPH_COUNTERS */
+QueryCounters Graph::getCounters() const { return totals.snapshot(); }
+
+/** set the totals returned by getCounters back to 0 */
+void Graph::resetCounters() { totals.reset(); }
+
+/** number of threads to use, 0 or less means one per core */
+static int threadCount(int threads)
+{
+	if (threads <= 0)
+		threads = static_cast<int>(std::thread::hardware_concurrency());
+	return threads <= 0 ? 1 : threads;
+}
+
+/** label every vertex with its weakly connected component
+edge direction is ignored, see components.h
+the edges are split between threads, 0 means one per core
+and merged in a lock-free union-find
+each thread takes a contiguous range of vertices and all their edges */
+Components Graph::weaklyConnectedComponents(int threads) const
+{
+	threads = threadCount(threads);
+	ConcurrentUnionFind sets(numberOfVertices);
+	auto uniteRange = [this, &sets](int first, int last) {
+		for (int v = first; v < last; v++)
 		{
-			mystack.push(*(vertices.at(current)));
-			vertices.at(current)->visit();
-			visit(current);
+			const Vertex::AdjacencyList& edges =
+				vertexList[v]->getAdjacencyList();
+			for (Vertex::AdjacencyList::const_iterator it = edges.begin();
+				it != edges.end(); it++)
+				sets.unite(v, it->getEndVertex());
 		}
+	};
+
+	int perThread = (numberOfVertices + threads - 1) / threads;
+	std::vector<std::thread> workers;
+	for (int first = 0; first < numberOfVertices; first += perThread)
+	{
+		int last = std::min(numberOfVertices, first + perThread);
+		if (threads == 1)
+			uniteRange(first, last);
 		else
-			mystack.pop();
+			workers.emplace_back(uniteRange, first, last);
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+
+	Components result;
+	result.graph = this;
+	sets.label(result.componentOf, result.sizes);
+	return result;
+}
+
+/** label every vertex with its strongly connected component
+Tarjan's algorithm in O(V + E) with an explicit stack, so deep
+graphs cannot overflow the call stack
+components are numbered in topological order, see components.h
+Tarjan finds sink components first, numbers are flipped at the end */
+Components Graph::stronglyConnectedComponents() const
+{
+	std::vector<int> order(numberOfVertices, -1); // discovery order
+	std::vector<int> lowlink(numberOfVertices, 0);
+	std::vector<char> onStack(numberOfVertices, 0);
+	std::vector<int> sccStack;
+	std::vector<QueryContext::DfsFrame> callStack;
+	Components result;
+	result.graph = this;
+	result.componentOf.assign(numberOfVertices, -1);
+	int counter = 0;
+
+	for (int root = 0; root < numberOfVertices; root++)
+	{
+		if (order[root] != -1)
+			continue;
+		order[root] = lowlink[root] = counter++;
+		sccStack.push_back(root);
+		onStack[root] = 1;
+		callStack.push_back(QueryContext::DfsFrame(root,
+			vertexList[root]->getAdjacencyList().begin()));
+
+		while (!callStack.empty())
+		{
+			QueryContext::DfsFrame& frame = callStack.back();
+			int v = frame.first;
+			if (frame.second != vertexList[v]->getAdjacencyList().end())
+			{
+				int w = frame.second->getEndVertex();
+				frame.second++;
+				if (order[w] == -1) // tree edge, "recurse" into w
+				{
+					order[w] = lowlink[w] = counter++;
+					sccStack.push_back(w);
+					onStack[w] = 1;
+					callStack.push_back(QueryContext::DfsFrame(w,
+						vertexList[w]->getAdjacencyList().begin()));
+				}
+				else if (onStack[w])
+					lowlink[v] = std::min(lowlink[v], order[w]);
+				continue;
+			}
+
+			// all neighbors done, "return" from v
+			callStack.pop_back();
+			if (!callStack.empty())
+			{
+				int parent = callStack.back().first;
+				lowlink[parent] = std::min(lowlink[parent], lowlink[v]);
+			}
+			if (lowlink[v] == order[v]) // v is the root of a component
+			{
+				int component = static_cast<int>(result.sizes.size());
+				result.sizes.push_back(0);
+				int w;
+				do
+				{
+					w = sccStack.back();
+					sccStack.pop_back();
+					onStack[w] = 0;
+					result.componentOf[w] = component;
+					result.sizes[component]++;
+				} while (w != v);
+			}
+		}
+	}
+
+	// reverse so that edges go from lower to higher numbers
+	int last = static_cast<int>(result.sizes.size()) - 1;
+	for (int v = 0; v < numberOfVertices; v++)
+		result.componentOf[v] = last - result.componentOf[v];
+	std::reverse(result.sizes.begin(), result.sizes.end());
+	return result;
+}
+
+/** build the DAG of strongly connected components
+components must come from stronglyConnectedComponents
+edges are bucketed by source component, then sorted and deduplicated */
+Condensation Graph::condense(const Components& components) const
+{
+	int numComponents = components.getNumComponents();
+	const std::vector<int>& componentOf = components.getComponentOf();
+	Condensation dag;
+	dag.offsets.assign(numComponents + 1, 0);
+
+	// count, then place, the edges that cross components
+	for (int pass = 0; pass < 2; pass++)
+	{
+		std::vector<int> next(dag.offsets.begin(), dag.offsets.end() - 1);
+		for (int v = 0; v < numberOfVertices; v++)
+		{
+			int from = componentOf[v];
+			const Vertex::AdjacencyList& edges =
+				vertexList[v]->getAdjacencyList();
+			for (Vertex::AdjacencyList::const_iterator it = edges.begin();
+				it != edges.end(); it++)
+			{
+				int to = componentOf[it->getEndVertex()];
+				if (to == from)
+					continue;
+				if (pass == 0)
+					dag.offsets[from + 1]++;
+				else
+					dag.targets[next[from]++] = to;
+			}
+		}
+		if (pass == 0)
+		{
+			for (int c = 0; c < numComponents; c++)
+				dag.offsets[c + 1] += dag.offsets[c];
+			dag.targets.resize(dag.offsets[numComponents]);
+		}
 	}
-}    
 
-//if no unvisited neighbor, returns startVertex label
-std::string Graph::findUnvisitedNeighbor(std::string startVertex)
+	// sort and drop duplicate edges, compacting in place
+	int write = 0;
+	for (int c = 0; c < numComponents; c++)
+	{
+		int first = dag.offsets[c];
+		int last = dag.offsets[c + 1];
+		std::sort(dag.targets.begin() + first, dag.targets.begin() + last);
+		dag.offsets[c] = write;
+		for (int i = first; i < last; i++)
+			if (i == first || dag.targets[i] != dag.targets[i - 1])
+				dag.targets[write++] = dag.targets[i];
+	}
+	dag.offsets[numComponents] = write;
+	dag.targets.resize(write);
+	return dag;
+}
+
+/** the k cheapest loopless paths from start to end, cheapest first
+Yen's algorithm, every spur search is a Djikstra that stops at end
+and skips the banned vertices and edges instead of removing them,
+so the graph is never changed and one QueryContext is reused
+returns fewer than k paths if there are no more
+edge weights must not be negative, throws std::domain_error if any
+is, the spur searches would return wrong or looping paths */
+std::vector<WeightedPath> Graph::kShortestPaths(const std::string& start,
+	const std::string& end, int k) const
 {
-    std::string unvisitedneighbor = 
-		vertices.at(startVertex)->getNextNeighbor();
-	int neighbors = vertices.at(startVertex)->getNumberOfNeighbors();
-	for (int i = 0; i < neighbors; i++)
+	if (negativeEdges > 0)
+		throw std::domain_error("k shortest paths need non-negative weights");
+	typedef std::pair<int, std::vector<int>> Candidate; // cost, path
+	int source = vertices.at(start)->getIndex();
+	int target = vertices.at(end)->getIndex();
+	QueryContext context;
+	std::vector<Candidate> found;
+	std::set<Candidate> candidates; // ordered and without duplicates
+	std::vector<int> banned;
+	std::vector<int> bannedNext;
+
+	// cost of the path's first n edges
+	auto prefixCost = [this](const std::vector<int>& path, size_t n) {
+		int cost = 0;
+		for (size_t i = 0; i < n; i++)
+			cost += vertexList[path[i]]->getEdgeWeight(
+				*vertexList[path[i + 1]], vertexList);
+		return cost;
+	};
+
+	std::vector<int> first = spurPath(source, target, banned, bannedNext,
+		context);
+	if (!first.empty() && k > 0)
+		found.push_back(Candidate(prefixCost(first, first.size() - 1),
+			first));
+
+	while (!found.empty() && static_cast<int>(found.size()) < k)
 	{
-		if (!(vertices.at(unvisitedneighbor)->isVisited()))
+		const std::vector<int>& last = found.back().second;
+		// every vertex but the end can be where the new path branches off
+		for (size_t i = 0; i + 1 < last.size(); i++)
+		{
+			// root is last[0..i], it must not be revisited
+			banned.assign(last.begin(), last.begin() + i);
+			// paths sharing this root may not leave it the same way
+			bannedNext.clear();
+			for (size_t p = 0; p < found.size(); p++)
+			{
+				const std::vector<int>& path = found[p].second;
+				if (path.size() > i + 1 &&
+					std::equal(last.begin(), last.begin() + i + 1,
+						path.begin()))
+					bannedNext.push_back(path[i + 1]);
+			}
+			std::vector<int> spur = spurPath(last[i], target, banned,
+				bannedNext, context);
+			if (spur.empty())
+				continue;
+			std::vector<int> path(last.begin(), last.begin() + i);
+			path.insert(path.end(), spur.begin(), spur.end());
+			candidates.insert(Candidate(prefixCost(path, path.size() - 1),
+				path));
+		}
+		if (candidates.empty())
 			break;
-		else
-			unvisitedneighbor = vertices.at(startVertex)->getNextNeighbor();	
+		found.push_back(*candidates.begin());
+		candidates.erase(candidates.begin());
+	}
+
+	std::vector<WeightedPath> result;
+	for (size_t p = 0; p < found.size(); p++)
+	{
+		std::vector<std::string> labels;
+		for (size_t i = 0; i < found[p].second.size(); i++)
+			labels.push_back(vertexList[found[p].second[i]]->getLabel());
+		result.push_back(WeightedPath(labels, found[p].first));
 	}
-	return unvisitedneighbor;
+	return result;
 }
 
-/** breadth-first traversal starting from startLabel
-call the function visit on each vertex label */
-void Graph::breadthFirstTraversal(std::string startLabel,      
-	void visit(const std::string&)) 
+/** Djikstra from spur to target for kShortestPaths
+vertices in banned are treated as already settled, edges from spur
+to vertices in bannedNext are ignored
+@return  path spur .. target as indices, empty if unreachable */
+std::vector<int> Graph::spurPath(int spur, int target,
+	const std::vector<int>& banned, const std::vector<int>& bannedNext,
+	QueryContext& context) const
 {
-	std::queue<Vertex> myqueue;
-	std::string neighbor;
-	std::string currentVertex = startLabel;
-	int size = 0;
+	std::vector<QueryContext::HeapEntry>& pq = context.getHeap();
+	std::greater<QueryContext::HeapEntry> order; // lowest cost on top
+	context.beginQuery(numberOfVertices);
+	for (size_t i = 0; i < banned.size(); i++)
+		context.settle(banned[i]);
 
-	this->unvisitVertices();
-	myqueue.push(*(vertices.at(startLabel)));
-	vertices.at(startLabel)->visit();
-	visit(startLabel);
-	
-	while (!myqueue.empty())
+	context.setDistance(spur, 0, -1);
+	pq.push_back(QueryContext::HeapEntry(0, spur));
+	while (!pq.empty() && !context.isSettled(target))
+	{
+		std::pop_heap(pq.begin(), pq.end(), order);
+		int v = pq.back().second;
+		int vCost = pq.back().first;
+		pq.pop_back();
+		if (context.isSettled(v) || vCost > context.getDistance(v))
+			continue; // stale entry, a cheaper one was already used
+		context.settle(v);
+
+		const Vertex::AdjacencyList& edges = vertexList[v]->getAdjacencyList();
+		for (Vertex::AdjacencyList::const_iterator it = edges.begin(),
+			it_end = edges.end(); it != it_end; it++)
+		{
+			int u = it->getEndVertex();
+			if (context.isSettled(u) || (v == spur &&
+				std::find(bannedNext.begin(), bannedNext.end(), u) !=
+				bannedNext.end()))
+				continue;
+			int cost = vCost + it->getWeight();
+			if (!context.isReached(u) || cost < context.getDistance(u))
+			{
+				context.setDistance(u, cost, v);
+				pq.push_back(QueryContext::HeapEntry(cost, u));
+				std::push_heap(pq.begin(), pq.end(), order);
+			}
+		}
+	}
+
+	std::vector<int> path;
+	if (!context.isReached(target) || !context.isSettled(target))
+		return path;
+	for (int v = target; v != -1; v = context.getPrevious(v))
+		path.push_back(v);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+/** return true if the graph has no directed cycle
+the answer and a topological order are cached until the next
+add or removeEdge */
+bool Graph::isAcyclic() const { return cachedTopologicalOrder() != nullptr; }
+
+/** return vertex labels in topological order, every edge goes
+from an earlier to a later vertex, empty if the graph has a cycle
+ties are broken by vertex index */
+std::vector<std::string> Graph::topologicalOrder() const
+{
+	std::vector<std::string> labels;
+	const std::vector<int>* order = cachedTopologicalOrder();
+	if (order == nullptr)
+		return labels;
+	labels.reserve(order->size());
+	for (size_t i = 0; i < order->size(); i++)
+		labels.push_back(vertexList[(*order)[i]]->getLabel());
+	return labels;
+}
+
+/** topological order as vertex indices
+@return  false and an empty order if the graph has a cycle */
+bool Graph::topologicalOrder(std::vector<int>& order) const
+{
+	const std::vector<int>* cached = cachedTopologicalOrder();
+	if (cached == nullptr)
+	{
+		order.clear();
+		return false;
+	}
+	order = *cached;
+	return true;
+}
+
+/** shortest paths on an acyclic graph in O(V + E), no heap
+relaxes edges in topological order, negative weights are fine
+@return  false and an empty result if the graph has a cycle */
+bool Graph::dagShortestPaths(std::string startLabel,
+	ShortestPaths& paths) const
+{
+	const Vertex* start = vertices.at(startLabel);
+	paths = ShortestPaths();
+	if (cachedTopologicalOrder() == nullptr)
+		return false;
+	QueryContext context;
+	dagHelper(start, topoOrder, topoPosition, context);
+	copyPaths(start, context, paths);
+	return true;
+}
+
+/** return true if any edge has a negative weight */
+bool Graph::hasNegativeWeights() const { return negativeEdges > 0; }
+
+/** shortest paths that allow negative edge weights, frontier
+Bellman-Ford split between threads, see bellmanFordHelper
+@return  false and an empty result if a negative cycle can be
+reached from startLabel */
+bool Graph::bellmanFordShortestPaths(std::string startLabel,
+	ShortestPaths& paths, int threads) const
+{
+	const Vertex* start = vertices.at(startLabel);
+	paths = ShortestPaths();
+	std::vector<int> cost;
+	std::vector<int> previous;
+	if (!bellmanFordHelper(std::vector<int>(1, start->getIndex()), cost,
+		previous, threads))
+		return false;
+	paths.graph = this;
+	paths.startIndex = start->getIndex();
+	paths.cost.swap(cost);
+	paths.previous.swap(previous);
+	return true;
+}
+
+/** shortest paths between every pair of vertices, Johnson's algorithm
+Bellman-Ford from a virtual source with a 0 edge to every vertex gives
+potential p, w + p[from] - p[to] is never negative for any edge
+Djikstra then runs on the real costs with the heap ordered by cost
+minus potential, so the edges are never rewritten
+each thread takes the next source and reuses one QueryContext
+@return  false and an empty result if the graph has a negative cycle */
+bool Graph::allPairsShortestPaths(std::vector<ShortestPaths>& paths,
+	int threads) const
+{
+	paths.clear();
+	std::vector<int> potential(numberOfVertices, 0);
+	if (negativeEdges > 0)
+	{
+		std::vector<int> all(numberOfVertices);
+		for (int v = 0; v < numberOfVertices; v++)
+			all[v] = v;
+		std::vector<int> ignore;
+		if (!bellmanFordHelper(all, potential, ignore, threads))
+			return false;
+	}
+
+	paths.resize(numberOfVertices);
+	std::atomic<int> nextSource(0);
+	auto runSources = [this, &paths, &potential, &nextSource]() {
+		QueryContext context;
+		auto ignore = [](int) {};
+		for (int s = nextSource++; s < numberOfVertices; s = nextSource++)
+		{
+			djikstraHelper(vertexList[s], context, ignore, potential.data());
+			copyPaths(vertexList[s], context, paths[s]);
+		}
+	};
+	threads = std::min(threadCount(threads), std::max(numberOfVertices, 1));
+	std::vector<std::thread> workers;
+	for (int t = 1; t < threads; t++)
+		workers.emplace_back(runSources);
+	runSources();
+	for (std::thread& worker : workers)
+		worker.join();
+	return true;
+}
+
+/** hint whether the graph may be acyclic, default true
+while true, djikstraCostToAllVertices checks for cycles once
+after each change and uses dagShortestPaths when there are none
+set false for graphs known to have cycles to skip the check */
+void Graph::setAcyclicHint(bool maybeAcyclic) { acyclicHint = maybeAcyclic; }
+
+/** shortest paths into the context, DAG relaxation when the graph
+is known to be acyclic, Bellman-Ford when it has negative edge
+weights, otherwise Djikstra
+throws std::domain_error if a negative cycle can be reached */
+void Graph::shortestPathHelper(const Vertex* start,
+	QueryContext& context) const
+{
+	const std::vector<int>* order =
+		acyclicHint ? cachedTopologicalOrder() : nullptr;
+	if (order != nullptr)
+		dagHelper(start, *order, topoPosition, context);
+	else if (negativeEdges > 0)
+	{
+		std::vector<int> cost;
+		std::vector<int> previous;
+		context.beginQuery(numberOfVertices);
+		if (!bellmanFordHelper(std::vector<int>(1, start->getIndex()),
+			cost, previous, 1, &context.getCounters()))
+			throw std::domain_error("negative cycle reachable from " +
+				start->getLabel());
+		context.setDistance(start->getIndex(), 0, -1);
+		for (int v = 0; v < numberOfVertices; v++)
+			if (v != start->getIndex() && cost[v] != INT_MAX)
+				context.setDistance(v, cost[v], previous[v]);
+		recordQuery(context);
+	}
+	else
+	{
+		auto ignore = [](int) {};
+		djikstraHelper(start, context, ignore);
+	}
+}
+
+/** relax edges in topological order, results in the context
+like djikstraHelper, order must be a topological order
+only vertices after start in the order can be reached */
+void Graph::dagHelper(const Vertex* start, const std::vector<int>& order,
+	const std::vector<int>& position, QueryContext& context) const
+{
+	QueryCounters& counters = context.getCounters();
+	context.beginQuery(numberOfVertices);
+	context.setDistance(start->getIndex(), 0, -1);
+	for (size_t i = position[start->getIndex()]; i < order.size(); i++)
+	{
+		int v = order[i];
+		if (!context.isReached(v))
+			continue;
+		context.settle(v);
+		GRAPH_COUNT(counters, verticesSettled, 1);
+		int vCost = context.getDistance(v);
+		const Vertex::AdjacencyList& edges = vertexList[v]->getAdjacencyList();
+		int count = static_cast<int>(edges.size());
+		int found = context.findImprovedEdges(edges.data(), count, vCost);
+		const std::vector<int>& improved = context.getImprovedEdges();
+		GRAPH_COUNT(counters, edgesRelaxed, count);
+		for (int i = 0; i < found; i++)
+		{
+			const Edge& edge = edges[improved[i]];
+			context.setDistance(edge.getEndVertex(),
+				vCost + edge.getWeight(), v);
+		}
+	}
+	recordQuery(context);
+}
+
+/** cost in the high half, previous vertex in the low half, so one
+compare-and-swap changes both together */
+static uint64_t packPath(int cost, int previous)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(cost)) << 32) |
+		static_cast<uint32_t>(previous);
+}
+
+static int packedCost(uint64_t packed)
+{ return static_cast<int>(static_cast<uint32_t>(packed >> 32)); }
+
+static int packedPrevious(uint64_t packed)
+{ return static_cast<int>(static_cast<uint32_t>(packed)); }
+
+/** smaller frontiers are relaxed by the calling thread alone */
+static const size_t minParallelFrontier = 1024;
+
+/** frontier Bellman-Ford starting from every source at cost 0
+round k relaxes the edges of the vertices whose cost dropped in round
+k - 1, threads lower costs with compare-and-swap and the first to
+lower a vertex in a round puts it in the next frontier
+without a negative cycle every cost is final after V - 1 rounds,
+so a frontier left after round V means there is one
+fills cost, INT_MAX if unreachable, and previous, -1 if none
+@return  false if a negative cycle can be reached */
+bool Graph::bellmanFordHelper(const std::vector<int>& sources,
+	std::vector<int>& cost, std::vector<int>& previous, int threads,
+	QueryCounters* counters) const
+{
+	threads = threadCount(threads);
+	std::unique_ptr<std::atomic<uint64_t>[]> best(
+		new std::atomic<uint64_t>[numberOfVertices]);
+	std::unique_ptr<std::atomic<int>[]> queuedRound(
+		new std::atomic<int>[numberOfVertices]);
+	for (int v = 0; v < numberOfVertices; v++)
 	{
-		currentVertex = myqueue.front().getLabel();
-		size = vertices.at(currentVertex)->getNumberOfNeighbors();
-		myqueue.pop();
-		for (int i = 0; i < size; i++)
+		best[v].store(packPath(INT_MAX, -1), std::memory_order_relaxed);
+		queuedRound[v].store(0, std::memory_order_relaxed);
+	}
+	std::vector<int> frontier;
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		best[sources[i]].store(packPath(0, -1), std::memory_order_relaxed);
+		frontier.push_back(sources[i]);
+	}
+
+	// relax the edges of frontier[first .. last), new vertices go to next
+	auto relaxRange = [this, &best, &queuedRound, &frontier](int round,
+		size_t first, size_t last, std::vector<int>& next) {
+		for (size_t i = first; i < last; i++)
 		{
-			neighbor = vertices.at(currentVertex)->getNextNeighbor();
-			if (!vertices.at(neighbor)->isVisited())
+			int v = frontier[i];
+			int vCost = packedCost(best[v].load(std::memory_order_relaxed));
+			const Vertex::AdjacencyList& edges =
+				vertexList[v]->getAdjacencyList();
+			for (size_t e = 0; e < edges.size(); e++)
 			{
-				visit(neighbor);
-				vertices.at(neighbor)->visit();
-				myqueue.push(*(vertices.at(neighbor)));
+				int u = edges[e].getEndVertex();
+				int uCost = vCost + edges[e].getWeight();
+				uint64_t old = best[u].load(std::memory_order_relaxed);
+				while (uCost < packedCost(old))
+				{
+					if (best[u].compare_exchange_weak(old, packPath(uCost, v),
+						std::memory_order_relaxed))
+					{
+						if (queuedRound[u].exchange(round,
+							std::memory_order_relaxed) != round)
+							next.push_back(u);
+						break;
+					}
+				}
 			}
-		}	
+		}
+	};
+
+	// the joins between rounds order every store before the next round
+	std::vector<std::vector<int>> next(threads);
+	for (int round = 1; !frontier.empty(); round++)
+	{
+		if (round > numberOfVertices)
+		{
+			cost.clear();
+			previous.clear();
+			return false; // still improving, there is a negative cycle
+		}
+		size_t size = frontier.size();
+#ifdef GRAPH_COUNTERS
+		if (counters != nullptr) // every edge of the frontier is relaxed
+		{
+			for (size_t i = 0; i < size; i++)
+				GRAPH_COUNT(*counters, edgesRelaxed, static_cast<long long>(
+					vertexList[frontier[i]]->getAdjacencyList().size()));
+			GRAPH_COUNT_MAX(*counters, frontierHighWater,
+				static_cast<long long>(size));
+		}
+#else
+		(void)counters;
+#endif
+		if (threads == 1 || size < minParallelFrontier)
+			relaxRange(round, 0, size, next[0]);
+		else
+		{
+			size_t perThread = (size + threads - 1) / threads;
+			std::vector<std::thread> workers;
+			for (int t = 0; t < threads && t * perThread < size; t++)
+				workers.emplace_back(relaxRange, round, t * perThread,
+					std::min(size, (t + 1) * perThread), std::ref(next[t]));
+			for (std::thread& worker : workers)
+				worker.join();
+		}
+		frontier.clear();
+		for (size_t t = 0; t < next.size(); t++)
+		{
+			frontier.insert(frontier.end(), next[t].begin(), next[t].end());
+			next[t].clear();
+		}
 	}
+
+	cost.resize(numberOfVertices);
+	previous.resize(numberOfVertices);
+	for (int v = 0; v < numberOfVertices; v++)
+	{
+		uint64_t packed = best[v].load(std::memory_order_relaxed);
+		cost[v] = packedCost(packed);
+		previous[v] = packedPrevious(packed);
+	}
+	return true;
 }
 
+/** return the cached topological order, computing it if needed
+nullptr if the graph has a cycle, the order is valid until the
+graph is changed
+Kahn's algorithm, vertices with no incoming edges go first */
+const std::vector<int>* Graph::cachedTopologicalOrder() const
+{
+	std::lock_guard<std::mutex> lock(topoMutex);
+	if (topoState == 0)
+	{
+		std::vector<int> inDegree(numberOfVertices, 0);
+		for (int v = 0; v < numberOfVertices; v++)
+		{
+			const Vertex::AdjacencyList& edges =
+				vertexList[v]->getAdjacencyList();
+			for (Vertex::AdjacencyList::const_iterator it = edges.begin();
+				it != edges.end(); it++)
+				inDegree[it->getEndVertex()]++;
+		}
+		topoOrder.clear();
+		topoOrder.reserve(numberOfVertices);
+		for (int v = 0; v < numberOfVertices; v++)
+			if (inDegree[v] == 0)
+				topoOrder.push_back(v);
+		// topoOrder doubles as the queue, head walks along it
+		for (size_t head = 0; head < topoOrder.size(); head++)
+		{
+			const Vertex::AdjacencyList& edges =
+				vertexList[topoOrder[head]]->getAdjacencyList();
+			for (Vertex::AdjacencyList::const_iterator it = edges.begin();
+				it != edges.end(); it++)
+			{
+				int u = it->getEndVertex();
+				if (--inDegree[u] == 0)
+					topoOrder.push_back(u);
+			}
+		}
+		topoState = static_cast<int>(topoOrder.size()) == numberOfVertices
+			? 1 : 2;
+		topoPosition.assign(numberOfVertices, -1);
+		if (topoState == 2)
+			topoOrder.clear();
+		for (size_t i = 0; i < topoOrder.size(); i++)
+			topoPosition[topoOrder[i]] = static_cast<int>(i);
+	}
+	return topoState == 1 ? &topoOrder : nullptr;
+}
+
+/** forget the cached order, called by every change to the edges */
+void Graph::edgesChanged()
+{
+	std::lock_guard<std::mutex> lock(topoMutex);
+	topoState = 0;
+}
+
+/** connect a batch of edges, the vertices already exist, like add
+for each in order, batch is left empty
+a stable sort by start vertex keeps each vertex's edges in the order
+they came, Vertex::connectAll keeps the first to each end vertex
+@return  number of edges added */
+int Graph::connectBatch(std::vector<BatchEdge>& batch)
+{
+	if (batch.empty())
+		return 0;
+	std::stable_sort(batch.begin(), batch.end(),
+		[](const BatchEdge& a, const BatchEdge& b) {
+		return a.first < b.first;
+	});
+	int added = 0;
+	std::vector<Edge> edges;
+	for (size_t i = 0; i < batch.size();)
+	{
+		int start = batch[i].first;
+		edges.clear();
+		for (; i < batch.size() && batch[i].first == start; i++)
+			edges.push_back(batch[i].second);
+		added += vertexList[start]->connectAll(edges, vertexList);
+		for (size_t e = 0; e < edges.size(); e++)
+			if (edges[e].getWeight() < 0)
+				negativeEdges++;
+	}
+	numberOfEdges += added;
+	batch.clear();
+	edgesChanged();
+	return added;
+}
+
+/** set one weight for updateWeight and updateWeights, appends to
+changes if the weight is different
+the topological order depends only on which edges there are, so it
+stays cached */
+bool Graph::changeWeight(Vertex* start, const Vertex* end, int newWeight,
+	std::vector<WeightChange>& changes)
+{
+	int oldWeight = 0;
+	if (end == nullptr ||
+		!start->setEdgeWeight(*end, newWeight, vertexList, oldWeight))
+		return false;
+	if (oldWeight == newWeight)
+		return true;
+	negativeEdges += (newWeight < 0 ? 1 : 0) - (oldWeight < 0 ? 1 : 0);
+	if (journal != nullptr)
+		journal->recordUpdate(start->getIndex(), end->getIndex(), newWeight);
+	changes.push_back(WeightChange{ start->getIndex(), end->getIndex(),
+		oldWeight, newWeight });
+	return true;
+}
+
+/** hand changes to every weight listener, if there are any */
+void Graph::weightsChanged(const std::vector<WeightChange>& changes) const
+{
+	if (changes.empty())
+		return;
+	for (size_t i = 0; i < weightListeners.size(); i++)
+		weightListeners[i].second(changes);
+}
+
+/** lazy depth-first traversal for range-for, see traversalrange.h
+only advances as far as the loop pulls */
+DepthFirstRange Graph::dfs(const std::string& startLabel) const
+{ return DepthFirstRange(*this, vertices.at(startLabel), nullptr); }
+
+/** lazy depth-first traversal using the caller's context
+the context must outlive the range */
+DepthFirstRange Graph::dfs(const std::string& startLabel,
+	QueryContext& context) const
+{ return DepthFirstRange(*this, vertices.at(startLabel), &context); }
+
+/** lazy breadth-first traversal for range-for, see traversalrange.h
+only advances as far as the loop pulls */
+BreadthFirstRange Graph::bfs(const std::string& startLabel) const
+{ return BreadthFirstRange(*this, vertices.at(startLabel), nullptr); }
+
+/** lazy breadth-first traversal using the caller's context
+the context must outlive the range */
+BreadthFirstRange Graph::bfs(const std::string& startLabel,
+	QueryContext& context) const
+{ return BreadthFirstRange(*this, vertices.at(startLabel), &context); }
+
 /** find the lowest cost from startLabel to all vertices that can be reached
 using Djikstra's shortest-path algorithm
 record costs in the given map weight
@@ -206,73 +1069,165 @@ which I am ignoring for readability */
 void Graph::djikstraCostToAllVertices(
 	std::string startLabel,
 	std::map<std::string, int>& weight,
-	std::map<std::string, std::string>& previous) 
-{
-	this->unvisitVertices();
-	std::string u = " ";
-	std::string v = " ";
-	int numOfNeighbors = vertices.at(startLabel)->getNumberOfNeighbors();
-	int vNeighbors = 0;
-	int v2ucost = 0;
+	std::map<std::string, std::string>& previous) const
+{
+	QueryContext context;
+	djikstraCostToAllVertices(startLabel, weight, previous, context);
+}
+
+/** Djikstra using the caller's context
+one context per thread lets queries run concurrently */
+void Graph::djikstraCostToAllVertices(
+	std::string startLabel,
+	std::map<std::string, int>& weight,
+	std::map<std::string, std::string>& previous,
+	QueryContext& context) const
+{
 	weight.clear();
 	previous.clear();
+	shortestPathHelper(vertices.at(startLabel), context);
 
-	typedef std::pair<int, std::string> P;
-	struct Order
+	// start vertex is not part of the result
+	const std::vector<int>& reached = context.getReached();
+	for (size_t i = 1; i < reached.size(); i++)
 	{
-		bool operator()(P a, P b) const
-		{
-			return a.first > b.first;
-		}
-	};
-	std::priority_queue<P,std::deque<P>, Order> pq;
-	std::set<std::string> vertexSet;
-	
-	for (int i = 0; i < numOfNeighbors; i++) // set initial weights
+		const Vertex* u = vertexList[reached[i]];
+		weight[u->getLabel()] = context.getDistance(reached[i]);
+		previous[u->getLabel()] =
+			vertexList[context.getPrevious(reached[i])]->getLabel();
+	}
+}
+
+/** Djikstra into flat arrays, see shortestpaths.h
+unlike the map version the start vertex is included with cost 0
+paths.pathTo("F") gives the whole path to "F" */
+void Graph::djikstraCostToAllVertices(std::string startLabel,
+	ShortestPaths& paths) const
+{
+	QueryContext context;
+	djikstraCostToAllVertices(startLabel, paths, context);
+}
+
+/** Djikstra into flat arrays using the caller's context
+reusing paths and context avoids all allocation */
+void Graph::djikstraCostToAllVertices(std::string startLabel,
+	ShortestPaths& paths, QueryContext& context) const
+{
+	const Vertex* start = vertices.at(startLabel);
+	shortestPathHelper(start, context);
+	copyPaths(start, context, paths);
+}
+
+/** bounded Djikstra, stops at a cost radius, after a number of
+settled vertices or once its targets are settled, see searchlimits.h
+weight and previous get only the settled vertices
+always Djikstra, throws std::domain_error if any edge weight is
+negative */
+void Graph::djikstraCostToAllVertices(
+	std::string startLabel,
+	std::map<std::string, int>& weight,
+	std::map<std::string, std::string>& previous,
+	const SearchLimits& limits) const
+{
+	QueryContext context;
+	djikstraCostToAllVertices(startLabel, weight, previous, limits, context);
+}
+
+/** bounded Djikstra using the caller's context
+the search leaves cheaper unsettled vertices in reached, skip them */
+void Graph::djikstraCostToAllVertices(
+	std::string startLabel,
+	std::map<std::string, int>& weight,
+	std::map<std::string, std::string>& previous,
+	const SearchLimits& limits, QueryContext& context) const
+{
+	weight.clear();
+	previous.clear();
+	boundedHelper(vertices.at(startLabel), limits, context);
+
+	// start vertex is not part of the result
+	const std::vector<int>& reached = context.getReached();
+	for (size_t i = 1; i < reached.size(); i++)
 	{
-		u = vertices.at(startLabel)->getNextNeighbor();
-		weight[u] = vertices.at(startLabel)->getEdgeWeight(u);
-		previous[u] = startLabel;
-		pq.push(P(weight[u], u));
+		if (!context.isSettled(reached[i]))
+			continue;
+		const Vertex* u = vertexList[reached[i]];
+		weight[u->getLabel()] = context.getDistance(reached[i]);
+		previous[u->getLabel()] =
+			vertexList[context.getPrevious(reached[i])]->getLabel();
 	}
-	vertexSet.insert((vertices.at(startLabel)->getLabel()));
-	while (!pq.empty())
+}
+
+/** bounded Djikstra into flat arrays, vertices that were not
+settled have no cost, like unreachable ones */
+void Graph::djikstraCostToAllVertices(std::string startLabel,
+	ShortestPaths& paths, const SearchLimits& limits) const
+{
+	QueryContext context;
+	djikstraCostToAllVertices(startLabel, paths, limits, context);
+}
+
+/** bounded Djikstra into flat arrays using the caller's context */
+void Graph::djikstraCostToAllVertices(std::string startLabel,
+	ShortestPaths& paths, const SearchLimits& limits,
+	QueryContext& context) const
+{
+	const Vertex* start = vertices.at(startLabel);
+	boundedHelper(start, limits, context);
+	copyPaths(start, context, paths, true);
+}
+
+/** bounded Djikstra into the context, see searchlimits.h
+the DAG relaxation and Bellman-Ford cannot stop early, so this is
+always Djikstra, which needs non-negative weights
+throws std::domain_error if any edge weight is negative */
+void Graph::boundedHelper(const Vertex* start, const SearchLimits& limits,
+	QueryContext& context) const
+{
+	if (negativeEdges > 0)
+		throw std::domain_error("search limits need non-negative weights");
+	auto ignore = [](int) {};
+	djikstraHelper(start, context, ignore, nullptr, &limits);
+}
+
+/** mark the target vertices as visited in context, Djikstra does
+not use the visited marks otherwise
+@return  number of different targets in the graph */
+int Graph::markTargets(const std::vector<std::string>& targets,
+	QueryContext& context) const
+{
+	int count = 0;
+	for (size_t i = 0; i < targets.size(); i++)
 	{
-		v = pq.top().second;// lowest cost, first in priority queue
-		vertexSet.insert((vertices.at(v)->getLabel()));
-		pq.pop();
-		if (vertexSet.find(v) != vertexSet.end())
+		const Vertex* target = findVertex(targets[i]);
+		if (target != nullptr && !context.isVisited(target->getIndex()))
 		{
-			vNeighbors = vertices.at(v)->getNumberOfNeighbors();
-			u = vertices.at(v)->getNextNeighbor();
-			for (int k = 0; k < vNeighbors; k++)
-			{
-				if (vertexSet.count(u) > 0)
-				{
-					u = vertices.at(v)->getNextNeighbor();
-					continue;
-				}
-				v2ucost = vertices.at(v)->getEdgeWeight(u);
-				if (weight.find(u) == weight.end())
-				{
-					weight[u] = weight[v] + v2ucost;
-					previous[u] = v;
-					pq.push(P(weight[u], u));
-				}
-				else
-				{
-					if (weight[u] > (weight[v] + v2ucost))
-					{
-						weight[u] = weight[v] + v2ucost;
-						previous[u] = v;
-						pq.push(P(weight[u], u));
-					}
-				}
-				u = vertices.at(v)->getNextNeighbor();
-			}
+			context.visit(target->getIndex());
+			count++;
 		}
 	}
-}															
+	return count;
+}
+
+/** copy the costs and previous vertices a query left in the context
+two array fills, then copy only the reached vertices
+with settledOnly, vertices reached but not settled are left out */
+void Graph::copyPaths(const Vertex* start, const QueryContext& context,
+	ShortestPaths& paths, bool settledOnly) const
+{
+	paths.graph = this;
+	paths.startIndex = start->getIndex();
+	paths.cost.assign(numberOfVertices, INT_MAX);
+	paths.previous.assign(numberOfVertices, -1);
+	const std::vector<int>& reached = context.getReached();
+	for (size_t i = 0; i < reached.size(); i++)
+	{
+		if (settledOnly && !context.isSettled(reached[i]))
+			continue;
+		paths.cost[reached[i]] = context.getDistance(reached[i]);
+		paths.previous[reached[i]] = context.getPrevious(reached[i]);
+	}
+}
 
 ///** helper for depthFirstTraversal */
 //void Graph::depthFirstTraversalHelper(Vertex* startVertex,  //not used
@@ -282,46 +1237,94 @@ void Graph::djikstraCostToAllVertices(
 //void Graph::breadthFirstTraversalHelper(Vertex*startVertex,  //not used
 //	void visit(const std::string&)) {}
 
-/** mark all verticies as unvisited */
-void Graph::unvisitVertices() 
-{
-	std::map<std::string, Vertex*>::iterator itr = vertices.begin();
-	while (itr != vertices.end())
-	{
-		itr->second->unvisit();
-		itr->second->resetNeighbor();
-		itr++;
-	}
-}
-
 /** find a vertex, if it does not exist return nullptr */
 Vertex* Graph::findVertex(const std::string& vertexLabel) const 
 { 
-	if (vertices.find(vertexLabel) != vertices.end())
-		return vertices.at(vertexLabel);
-	else
-		return nullptr; 
+	return vertices.find(vertexLabel);
 }
 
 /** find a vertex, if it does not exist create it and return it */
 Vertex* Graph::findOrCreateVertex(const std::string& vertexLabel) 
 
 { 
-	if (findVertex(vertexLabel) == nullptr)
+	Vertex * found = findVertex(vertexLabel);
+	if (found == nullptr)
 	{
-		Vertex * newVertex = new Vertex(vertexLabel);
-		vertices[vertexLabel] = newVertex;
-		vertices.at(newVertex->getLabel())->resetNeighbor();
+		Vertex * newVertex = new Vertex(vertexLabel, numberOfVertices);
+		vertexList.push_back(newVertex);
+		vertices.insert(newVertex);
 		numberOfVertices++;
 		return newVertex;
 	}
 	else
-		return findVertex(vertexLabel);
+		return found;
 }	
  //public access method for disconnect
 bool Graph::removeEdge(std::string start, std::string end)
 {
+	const Vertex* endVertex = findVertex(end);
+	Vertex* startVertex = vertices.at(start);
+	if (endVertex == nullptr)
+		return false;
+	int weight = startVertex->getEdgeWeight(*endVertex, vertexList);
+	if (!startVertex->disconnect(*endVertex, vertexList))
+		return false;
 	numberOfEdges--;
-	return vertices.at(start)->disconnect(end);
+	if (weight < 0)
+		negativeEdges--;
+	edgesChanged();
+	if (journal != nullptr)
+		journal->recordRemove(startVertex->getIndex(), endVertex->getIndex());
+	return true;
+}
+
+/** change the weight of the edge from start to end in place
+@return  false if there is no such edge, nothing changes
+throws std::out_of_range if start is not in the graph */
+bool Graph::updateWeight(std::string start, std::string end, int newWeight)
+{
+	Vertex* startVertex = vertices.at(start);
+	std::vector<WeightChange> changes;
+	bool found = changeWeight(startVertex, findVertex(end), newWeight,
+		changes);
+	weightsChanged(changes);
+	return found;
+}
+
+/** change many weights in place, in order, see updateWeight
+listeners see the graph after the whole batch
+@return  number of edges found */
+int Graph::updateWeights(const std::vector<WeightUpdate>& updates)
+{
+	std::vector<WeightChange> changes;
+	int found = 0;
+	for (size_t i = 0; i < updates.size(); i++)
+	{
+		Vertex* startVertex = findVertex(updates[i].start);
+		if (startVertex != nullptr && changeWeight(startVertex,
+			findVertex(updates[i].end), updates[i].weight, changes))
+			found++;
+	}
+	weightsChanged(changes);
+	return found;
+}
+
+/** call listener after every change of weights
+@return  id to give removeWeightListener */
+int Graph::addWeightListener(
+	std::function<void(const std::vector<WeightChange>&)> listener)
+{
+	weightListeners.push_back(std::make_pair(nextListenerId, listener));
+	return nextListenerId++;
 }
 
+/** stop calling the listener with this id */
+void Graph::removeWeightListener(int id)
+{
+	for (size_t i = 0; i < weightListeners.size(); i++)
+		if (weightListeners[i].first == id)
+		{
+			weightListeners.erase(weightListeners.begin() + i);
+			return;
+		}
+}
@@ -6,11 +6,36 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <algorithm>
+#include <climits>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "vertex.h"
+#include "components.h"
 #include "edge.h"
+#include "graphmemory.h"
+#include "labelindex.h"
+#include "querycontext.h"
+#include "querycounters.h"
+#include "searchlimits.h"
+#include "shortestpaths.h"
+#include "traversal.h"
+#include "traversalrange.h"
+#include "weightchange.h"
+
+class GraphJournal;
+
+/** one edge by label, see Graph::addEdges */
+struct LabeledEdge {
+	std::string start;
+	std::string end;
+	int weight;
+};
 
 class Graph {
 public:
@@ -18,7 +43,7 @@ public:
 	Graph();
 
 	/** destructor, delete all vertices and edges
-	only vertices stored in map
+	only vertices stored in vertexList
 	no pointers to edges created by graph */
 	~Graph();
 
@@ -32,28 +57,195 @@ public:
 	if the vertices do not exist, create them
 	calls Vertex::connect
 	a vertex cannot connect to itself
-	or have multiple edges to another vertex */
+	or have multiple edges to another vertex
+	the edge is inserted into a sorted list, O(degree) moves, so
+	building a hub one add at a time is O(degree^2), use addEdges or
+	readFile for bulk loads */
 	bool add(std::string start, std::string end, int edgeWeight = 0);
 
+	/** return an estimate of the memory used by this graph
+	broken down by vertex map, vertices, labels, adjacency and edges */
+	GraphMemoryUsage memoryUsage() const;
+
+	/** return the index of a vertex, -1 if it does not exist
+	indices run from 0 to getNumVertices() - 1 in creation order */
+	int getVertexIndex(const std::string& label) const;
+
+	/** return the label of the vertex with the given index */
+	const std::string& getVertexLabel(int index) const;
+
+	/** return every vertex index, in alphabetical order of the labels
+	the lookup table is unordered, use this where order matters */
+	std::vector<int> sortedVertexIndices() const;
+
 	/** return weight of the edge between start and end
-	returns INT_MAX if not connected or vertices don't exist */
+	returns INT_MAX if not connected or vertices don't exist,
+	-1 is a weight like any other
+	throws std::out_of_range if start is not in the graph */
 	int getEdgeWeight(std::string start, std::string end) const;
 
 	/** read edges from file
 	the first line of the file is an integer, indicating number of edges
 	each edge line is in the form of "string string int"
-	fromVertex  toVertex    edgeWeight */
+	fromVertex  toVertex    edgeWeight
+	like add for every line, but the edges are collected and merged
+	into the adjacency lists in batches */
 	void readFile(std::string filename);
 
+	/** add many edges, like add for each in order, vertices get the
+	same indices, but each adjacency list is merged once instead of
+	one sorted insert per edge, so a high degree vertex is not
+	O(degree^2), with a journal the edges are added one at a time
+	@return  number of edges added */
+	int addEdges(const std::vector<LabeledEdge>& edges);
+
 	/** depth-first traversal starting from startLabel
-	call the function visit on each vertex label */
+	call the function visit on each vertex label
+	uses a temporary QueryContext, the graph is not modified */
 	void depthFirstTraversal(std::string startLabel,
-		void visit(const std::string&));
+		void visit(const std::string&)) const;
+
+	/** depth-first traversal using the caller's context
+	one context per thread lets traversals run concurrently */
+	void depthFirstTraversal(std::string startLabel,
+		void visit(const std::string&), QueryContext& context) const;
+
+	/** depth-first traversal calling any visitor, see traversal.h
+	the visitor can be a lambda with captures and is inlined
+	it gets index, label and depth and can return a TraversalControl
+	to skip the vertex's children or stop the traversal early */
+	template <typename Visitor>
+	void depthFirstTraversal(const std::string& startLabel,
+		Visitor&& visitor) const;
+
+	/** templated depth-first traversal using the caller's context */
+	template <typename Visitor>
+	void depthFirstTraversal(const std::string& startLabel,
+		Visitor&& visitor, QueryContext& context) const;
 
 	/** breadth-first traversal starting from startLabel
-	call the function visit on each vertex label */
+	call the function visit on each vertex label
+	uses a temporary QueryContext, the graph is not modified */
+	void breadthFirstTraversal(std::string startLabel,
+		void visit(const std::string&)) const;
+
+	/** breadth-first traversal using the caller's context
+	one context per thread lets traversals run concurrently */
 	void breadthFirstTraversal(std::string startLabel,
-		void visit(const std::string&));
+		void visit(const std::string&), QueryContext& context) const;
+
+	/** breadth-first traversal calling any visitor, see traversal.h
+	depth is the number of edges on the shortest path from start */
+	template <typename Visitor>
+	void breadthFirstTraversal(const std::string& startLabel,
+		Visitor&& visitor) const;
+
+	/** templated breadth-first traversal using the caller's context */
+	template <typename Visitor>
+	void breadthFirstTraversal(const std::string& startLabel,
+		Visitor&& visitor, QueryContext& context) const;
+
+	/** work done by every finished query on this graph so far
+	see querycounters.h, all 0 unless built with GRAPH_COUNTERS */
+	QueryCounters getCounters() const;
+
+	/** set the totals returned by getCounters back to 0 */
+	void resetCounters();
+
+	/** label every vertex with its weakly connected component
+	edge direction is ignored, see components.h
+	the edges are split between threads, 0 means one per core
+	and merged in a lock-free union-find */
+	Components weaklyConnectedComponents(int threads = 0) const;
+
+	/** label every vertex with its strongly connected component
+	Tarjan's algorithm in O(V + E) with an explicit stack, so deep
+	graphs cannot overflow the call stack
+	components are numbered in topological order, see components.h */
+	Components stronglyConnectedComponents() const;
+
+	/** build the DAG of strongly connected components
+	components must come from stronglyConnectedComponents */
+	Condensation condense(const Components& components) const;
+
+	/** the k cheapest loopless paths from start to end, cheapest first
+	Yen's algorithm, every spur search is a Djikstra that stops at end
+	and skips the banned vertices and edges instead of removing them,
+	so the graph is never changed and one QueryContext is reused
+	returns fewer than k paths if there are no more
+	edge weights must not be negative, throws std::domain_error if any
+	is, the spur searches would return wrong or looping paths */
+	std::vector<WeightedPath> kShortestPaths(const std::string& start,
+		const std::string& end, int k) const;
+
+	/** return true if the graph has no directed cycle
+	the answer and a topological order are cached until the next
+	add or removeEdge */
+	bool isAcyclic() const;
+
+	/** return vertex labels in topological order, every edge goes
+	from an earlier to a later vertex, empty if the graph has a cycle
+	ties are broken by vertex index */
+	std::vector<std::string> topologicalOrder() const;
+
+	/** topological order as vertex indices
+	@return  false and an empty order if the graph has a cycle */
+	bool topologicalOrder(std::vector<int>& order) const;
+
+	/** shortest paths on an acyclic graph in O(V + E), no heap
+	relaxes edges in topological order, negative weights are fine
+	@return  false and an empty result if the graph has a cycle */
+	bool dagShortestPaths(std::string startLabel,
+		ShortestPaths& paths) const;
+
+	/** return true if any edge has a negative weight
+	djikstraCostToAllVertices then uses Bellman-Ford on graphs with
+	cycles, Djikstra's answer could be wrong */
+	bool hasNegativeWeights() const;
+
+	/** shortest paths that allow negative edge weights
+	frontier Bellman-Ford: each round only relaxes the edges of vertices
+	whose cost dropped in the round before, a large frontier is split
+	between threads, 0 means one per core
+	where shortest paths tie the previous vertex can depend on thread
+	timing, the costs cannot
+	@return  false and an empty result if a negative cycle can be
+	reached from startLabel */
+	bool bellmanFordShortestPaths(std::string startLabel,
+		ShortestPaths& paths, int threads = 0) const;
+
+	/** shortest paths between every pair of vertices, Johnson's algorithm
+	one Bellman-Ford gives each vertex a potential that makes every edge
+	weight non-negative, then Djikstra runs from every vertex, sources
+	are shared between threads, 0 means one per core
+	paths[i] starts at the vertex with index i, O(V^2) memory
+	@return  false and an empty result if the graph has a negative cycle */
+	bool allPairsShortestPaths(std::vector<ShortestPaths>& paths,
+		int threads = 0) const;
+
+	/** hint whether the graph may be acyclic, default true
+	while true, djikstraCostToAllVertices checks for cycles once
+	after each change and uses dagShortestPaths when there are none
+	set false for graphs known to have cycles to skip the check */
+	void setAcyclicHint(bool maybeAcyclic);
+
+	/** lazy depth-first traversal for range-for, see traversalrange.h
+	only advances as far as the loop pulls */
+	DepthFirstRange dfs(const std::string& startLabel) const;
+
+	/** lazy depth-first traversal using the caller's context
+	the context must outlive the range */
+	DepthFirstRange dfs(const std::string& startLabel,
+		QueryContext& context) const;
+
+	/** lazy breadth-first traversal for range-for, see traversalrange.h
+	only advances as far as the loop pulls */
+	BreadthFirstRange bfs(const std::string& startLabel) const;
+
+	/** lazy breadth-first traversal using the caller's context
+	the context must outlive the range */
+	BreadthFirstRange bfs(const std::string& startLabel,
+		QueryContext& context) const;
 
 	/** find the lowest cost from startLabel to all vertices that can be reached
 	using Djikstra's shortest-path algorithm
@@ -61,28 +253,257 @@ public:
 	weight["F"] = 10 indicates the cost to get to "F" is 10
 	record the shortest path to each vertex using given map previous
 	previous["F"] = "C" indicates get to "F" via "C"
+	with negative edge weights on a graph with cycles a single-threaded
+	Bellman-Ford is used instead, throws std::domain_error if a
+	negative cycle can be reached from startLabel
 
 	cpplint gives warning to use pointer instead of a non-const map
 	which I am ignoring for readability */
 	void djikstraCostToAllVertices(
 		std::string startLabel,
 		std::map<std::string, int>& weight,
-		std::map<std::string, std::string>& previous);
+		std::map<std::string, std::string>& previous) const;
+
+	/** Djikstra using the caller's context
+	one context per thread lets queries run concurrently */
+	void djikstraCostToAllVertices(
+		std::string startLabel,
+		std::map<std::string, int>& weight,
+		std::map<std::string, std::string>& previous,
+		QueryContext& context) const;
+
+	/** Djikstra into flat arrays, see shortestpaths.h
+	unlike the map version the start vertex is included with cost 0
+	paths.pathTo("F") gives the whole path to "F" */
+	void djikstraCostToAllVertices(std::string startLabel,
+		ShortestPaths& paths) const;
+
+	/** Djikstra into flat arrays using the caller's context
+	reusing paths and context avoids all allocation */
+	void djikstraCostToAllVertices(std::string startLabel,
+		ShortestPaths& paths, QueryContext& context) const;
+
+	/** bounded Djikstra, stops at a cost radius, after a number of
+	settled vertices or once its targets are settled, see searchlimits.h
+	weight and previous get only the settled vertices
+	always Djikstra, throws std::domain_error if any edge weight is
+	negative */
+	void djikstraCostToAllVertices(
+		std::string startLabel,
+		std::map<std::string, int>& weight,
+		std::map<std::string, std::string>& previous,
+		const SearchLimits& limits) const;
+
+	/** bounded Djikstra using the caller's context */
+	void djikstraCostToAllVertices(
+		std::string startLabel,
+		std::map<std::string, int>& weight,
+		std::map<std::string, std::string>& previous,
+		const SearchLimits& limits, QueryContext& context) const;
+
+	/** bounded Djikstra into flat arrays, vertices that were not
+	settled have no cost, like unreachable ones */
+	void djikstraCostToAllVertices(std::string startLabel,
+		ShortestPaths& paths, const SearchLimits& limits) const;
+
+	/** bounded Djikstra into flat arrays using the caller's context */
+	void djikstraCostToAllVertices(std::string startLabel,
+		ShortestPaths& paths, const SearchLimits& limits,
+		QueryContext& context) const;
 
-	//test disconnect
+	/** Djikstra streaming each vertex to sink as soon as it is settled
+	sink is any callable taking a const SettledVertex&, such as a
+	ShortestPathWriter, records come out in order of increasing cost
+	starting with startLabel itself at cost 0
+	nothing but the context's working arrays is kept in memory
+	edge weights must not be negative, throws std::domain_error if any
+	is, records already streamed could have the wrong cost */
+	template <typename Sink>
+	void djikstraStream(const std::string& startLabel, Sink&& sink) const;
+
+	/** streaming Djikstra using the caller's context */
+	template <typename Sink>
+	void djikstraStream(const std::string& startLabel, Sink&& sink,
+		QueryContext& context) const;
+
+	/** remove the edge from start to end
+	@return  false if there is no such edge, nothing changes
+	throws std::out_of_range if start is not in the graph */
 	bool removeEdge(std::string start, std::string end);
 
+	/** change the weight of the edge from start to end in place
+	the edge is not removed and added again, so the edge count and the
+	cached topological order stay, weight listeners get the change
+	@return  false if there is no such edge, nothing changes
+	throws std::out_of_range if start is not in the graph */
+	bool updateWeight(std::string start, std::string end, int newWeight);
+
+	/** change many weights in place, in order, see updateWeight
+	updates of edges or vertices that do not exist are skipped,
+	weight listeners are called once with all the changes
+	@return  number of edges found */
+	int updateWeights(const std::vector<WeightUpdate>& updates);
+
+	/** call listener after every updateWeight and updateWeights that
+	changes a weight, with the changes in the order they were made
+	listeners are called in the order added and must not change
+	weights themselves
+	@return  id to give removeWeightListener */
+	int addWeightListener(
+		std::function<void(const std::vector<WeightChange>&)> listener);
+
+	/** stop calling the listener with this id */
+	void removeWeightListener(int id);
+
 private:
+	/** ranges step through the adjacency lists themselves */
+	friend class DepthFirstRange;
+	friend class CompressedGraph;
+	friend class PartitionedGraph;
+	friend class BreadthFirstRange;
+	friend class GraphJournal;
+
 	/** number of vertices in graph */
 	int numberOfVertices;
 
 	/** number of edges in graph */
 	int numberOfEdges;
 
-	/** mapping from vertex label to vertex pointer for quick access */
-	std::map<std::string, Vertex*> vertices;
+	/** hash table from vertex label to vertex pointer, see labelindex.h
+	vertices.at(label) throws std::out_of_range like std::map::at */
+	LabelIndex vertices;
+
+	/** vertices in the order created, position is Vertex::getIndex */
+	std::vector<Vertex*> vertexList;
+
+	/** number of edges with a negative weight */
+	int negativeEdges{ 0 };
+
+	/** set by addWeightListener, with their ids */
+	std::vector<std::pair<int,
+		std::function<void(const std::vector<WeightChange>&)>>>
+		weightListeners;
+	int nextListenerId{ 0 };
+
+	/** records every add and removeEdge once set, see graphjournal.h
+	set and cleared by GraphJournal */
+	GraphJournal* journal{ nullptr };
+
+	/** set by setAcyclicHint */
+	bool acyclicHint{ true };
+
+	/** cached topological order and position of each vertex in it
+	topoState is 0 not computed, 1 acyclic, 2 has a cycle
+	guarded by topoMutex as queries on a const graph fill it */
+	mutable std::mutex topoMutex;
+	mutable int topoState{ 0 };
+	mutable std::vector<int> topoOrder;
+	mutable std::vector<int> topoPosition;
+
+	/** totals of all queries, queries on a const graph add to them */
+	mutable GraphCounters totals;
+
+	/** add the counters of a finished query to totals
+	compiles to nothing without GRAPH_COUNTERS */
+	void recordQuery(const QueryContext& context) const
+	{
+#ifdef GRAPH_COUNTERS
+		totals.record(context.getCounters());
+#else
+		(void)context;
+#endif
+	}
+
+	/** helper for depthFirstTraversal, every overload ends up here */
+	template <typename Visitor>
+	void depthFirstTraversalHelper(const Vertex* start, Visitor& visitor,
+		QueryContext& context) const;
+
+	/** helper for breadthFirstTraversal, every overload ends up here */
+	template <typename Visitor>
+	void breadthFirstTraversalHelper(const Vertex* start, Visitor& visitor,
+		QueryContext& context) const;
+
+	/** Djikstra from spur to target for kShortestPaths
+	vertices in banned are treated as already settled, edges from spur
+	to vertices in bannedNext are ignored
+	@return  path spur .. target as indices, empty if unreachable */
+	std::vector<int> spurPath(int spur, int target,
+		const std::vector<int>& banned, const std::vector<int>& bannedNext,
+		QueryContext& context) const;
+
+	/** shortest paths into the context, DAG relaxation when the graph
+	is known to be acyclic, otherwise Djikstra */
+	void shortestPathHelper(const Vertex* start, QueryContext& context) const;
+
+	/** frontier Bellman-Ford starting from every source at cost 0
+	fills cost, INT_MAX if unreachable, and previous, -1 if none
+	adds the edges relaxed and the largest frontier to counters
+	@return  false if a negative cycle can be reached */
+	bool bellmanFordHelper(const std::vector<int>& sources,
+		std::vector<int>& cost, std::vector<int>& previous,
+		int threads, QueryCounters* counters = nullptr) const;
+
+	/** bounded Djikstra into the context, see searchlimits.h
+	throws std::domain_error if any edge weight is negative */
+	void boundedHelper(const Vertex* start, const SearchLimits& limits,
+		QueryContext& context) const;
+
+	/** mark the target vertices as visited in context, Djikstra does
+	not use the visited marks otherwise
+	@return  number of different targets in the graph */
+	int markTargets(const std::vector<std::string>& targets,
+		QueryContext& context) const;
+
+	/** copy the costs and previous vertices a query left in the context
+	with settledOnly, vertices reached but not settled are left out */
+	void copyPaths(const Vertex* start, const QueryContext& context,
+		ShortestPaths& paths, bool settledOnly = false) const;
+
+	/** relax edges in topological order, results in the context
+	like djikstraHelper, order must be a topological order */
+	void dagHelper(const Vertex* start, const std::vector<int>& order,
+		const std::vector<int>& position, QueryContext& context) const;
 
-	std::string findUnvisitedNeighbor(std::string startVertex);
+	/** return the cached topological order, computing it if needed
+	nullptr if the graph has a cycle, the order is valid until the
+	graph is changed */
+	const std::vector<int>* cachedTopologicalOrder() const;
+
+	/** forget the cached order, called by every change to the edges */
+	void edgesChanged();
+
+	/** start vertex index and edge, for connectBatch */
+	typedef std::pair<int, Edge> BatchEdge;
+
+	/** connect a batch of edges, the vertices already exist, like add
+	for each in order, batch is left empty
+	@return  number of edges added */
+	int connectBatch(std::vector<BatchEdge>& batch);
+
+	/** put a batch through connectBatch once it is this big, or half
+	the edges, so a vertex's list is merged O(log edges) times */
+	static constexpr size_t minBatch = 1 << 16;
+
+	/** set one weight for updateWeight and updateWeights, appends to
+	changes if the weight is different
+	@return  false if there is no such edge */
+	bool changeWeight(Vertex* start, const Vertex* end, int newWeight,
+		std::vector<WeightChange>& changes);
+
+	/** hand changes to every weight listener, if there are any */
+	void weightsChanged(const std::vector<WeightChange>& changes) const;
+
+	/** helper for djikstraCostToAllVertices, every overload ends up here
+	leaves costs and previous vertices in the context
+	calls onSettle(vertex index) as each vertex gets its final cost
+	with a potential per vertex the heap is ordered by cost minus
+	potential, Johnson's reweighting without changing the edges
+	with limits the search stops early, limits need no potential */
+	template <typename OnSettle>
+	void djikstraHelper(const Vertex* start, QueryContext& context,
+		OnSettle& onSettle, const int* potential = nullptr,
+		const SearchLimits* limits = nullptr) const;
 
 	///** helper for depthFirstTraversal */
 	//void depthFirstTraversalHelper(Vertex* startVertex,
@@ -92,9 +513,6 @@ private:
 	//void breadthFirstTraversalHelper(Vertex*startVertex,
 	//	void visit(const std::string&));
 
-	/** mark all verticies as unvisited */
-	void unvisitVertices();
-
 	/** find a vertex, if it does not exist return nullptr */
 	Vertex* findVertex(const std::string& vertexLabel) const;
 
@@ -102,4 +520,255 @@ private:
 	Vertex* findOrCreateVertex(const std::string& vertexLabel);
 };  // end Graph
 
+/** depth-first traversal calling any visitor, see traversal.h */
+template <typename Visitor>
+void Graph::depthFirstTraversal(const std::string& startLabel,
+	Visitor&& visitor) const
+{
+	QueryContext context;
+	depthFirstTraversalHelper(vertices.at(startLabel), visitor, context);
+}
+
+/** templated depth-first traversal using the caller's context */
+template <typename Visitor>
+void Graph::depthFirstTraversal(const std::string& startLabel,
+	Visitor&& visitor, QueryContext& context) const
+{
+	depthFirstTraversalHelper(vertices.at(startLabel), visitor, context);
+}
+
+/** breadth-first traversal calling any visitor, see traversal.h */
+template <typename Visitor>
+void Graph::breadthFirstTraversal(const std::string& startLabel,
+	Visitor&& visitor) const
+{
+	QueryContext context;
+	breadthFirstTraversalHelper(vertices.at(startLabel), visitor, context);
+}
+
+/** templated breadth-first traversal using the caller's context */
+template <typename Visitor>
+void Graph::breadthFirstTraversal(const std::string& startLabel,
+	Visitor&& visitor, QueryContext& context) const
+{
+	breadthFirstTraversalHelper(vertices.at(startLabel), visitor, context);
+}
+
+/** Djikstra streaming each vertex to sink as soon as it is settled */
+template <typename Sink>
+void Graph::djikstraStream(const std::string& startLabel, Sink&& sink) const
+{
+	QueryContext context;
+	djikstraStream(startLabel, sink, context);
+}
+
+/** streaming Djikstra using the caller's context */
+template <typename Sink>
+void Graph::djikstraStream(const std::string& startLabel, Sink&& sink,
+	QueryContext& context) const
+{
+	if (negativeEdges > 0)
+		throw std::domain_error("streaming needs non-negative weights");
+	auto onSettle = [this, &sink, &context](int v) {
+		int prev = context.getPrevious(v);
+		sink(SettledVertex(v, vertexList[v]->getLabel(),
+			context.getDistance(v), prev,
+			prev == -1 ? nullptr : &vertexList[prev]->getLabel()));
+	};
+	djikstraHelper(vertices.at(startLabel), context, onSettle);
+}
+
+/** helper for djikstraCostToAllVertices, every overload ends up here
+leaves costs and previous vertices in the context
+the start vertex is reached first, so it is getReached()[0]
+the context holds real costs, the heap holds cost minus potential,
+which orders vertices like Djikstra on the reweighted edges
+limits stop it after the settle that reaches one, with a cost radius
+nothing past it is pushed, so everything on the heap is within it */
+template <typename OnSettle>
+void Graph::djikstraHelper(const Vertex* start, QueryContext& context,
+	OnSettle& onSettle, const int* potential,
+	const SearchLimits* limits) const
+{
+	std::vector<QueryContext::HeapEntry>& pq = context.getHeap();
+	std::greater<QueryContext::HeapEntry> order; // lowest cost on top
+	context.beginQuery(numberOfVertices);
+	int maxCost = INT_MAX;
+	int settleLeft = INT_MAX;
+	int targetsLeft = 0; // targets are marked visited, 0 none
+	if (limits != nullptr)
+	{
+		maxCost = limits->maxCost;
+		settleLeft = limits->maxSettled;
+		targetsLeft = markTargets(limits->targets, context);
+		if (limits->anyTarget)
+			targetsLeft = std::min(targetsLeft, 1);
+	}
+
+	QueryCounters& counters = context.getCounters();
+	context.setDistance(start->getIndex(), 0, -1);
+	pq.push_back(QueryContext::HeapEntry(0, start->getIndex()));
+	GRAPH_COUNT(counters, heapPushes, 1);
+	while (!pq.empty())
+	{
+		std::pop_heap(pq.begin(), pq.end(), order);
+		int v = pq.back().second; // lowest cost, first in priority queue
+		int key = pq.back().first;
+		pq.pop_back();
+		int vCost = context.getDistance(v);
+		if (context.isSettled(v) ||
+			key > vCost - (potential == nullptr ? 0 : potential[v]))
+		{
+			GRAPH_COUNT(counters, stalePops, 1);
+			continue; // stale entry, a cheaper one was already used
+		}
+		context.settle(v);
+		GRAPH_COUNT(counters, verticesSettled, 1);
+		onSettle(v);
+		if (--settleLeft <= 0 ||
+			(context.isVisited(v) && --targetsLeft == 0))
+			break; // a limit is reached, the rest need not be settled
+
+		// the kernel finds the edges that lower a cost, see relaxkernel.h
+		const Vertex::AdjacencyList& edges = vertexList[v]->getAdjacencyList();
+		int count = static_cast<int>(edges.size());
+		int found = context.findImprovedEdges(edges.data(), count, vCost);
+		const std::vector<int>& improved = context.getImprovedEdges();
+		GRAPH_COUNT(counters, edgesRelaxed, count);
+		for (int i = 0; i < found; i++)
+		{
+			const Edge& edge = edges[improved[i]];
+			int u = edge.getEndVertex();
+			int cost = vCost + edge.getWeight();
+			if (!context.isSettled(u) && cost <= maxCost)
+			{
+				context.setDistance(u, cost, v);
+				pq.push_back(QueryContext::HeapEntry(
+					cost - (potential == nullptr ? 0 : potential[u]), u));
+				std::push_heap(pq.begin(), pq.end(), order);
+				GRAPH_COUNT(counters, heapPushes, 1);
+				GRAPH_COUNT_MAX(counters, frontierHighWater,
+					static_cast<long long>(pq.size()));
+			}
+		}
+	}
+	recordQuery(context);
+}
+
+/** helper for depthFirstTraversal, every overload ends up here
+a vertex is visited when first found, so the order is preorder with
+neighbors in alphabetical order */
+template <typename Visitor>
+void Graph::depthFirstTraversalHelper(const Vertex* start, Visitor& visitor,
+	QueryContext& context) const
+{
+	std::vector<QueryContext::DfsFrame>& mystack = context.getStack();
+	QueryCounters& counters = context.getCounters();
+	context.beginQuery(numberOfVertices);
+
+	context.visit(start->getIndex());
+	TraversalControl control = callVisitor(visitor,
+		TraversalVisit(start->getIndex(), start->getLabel(), 0));
+	if (control == TraversalControl::Continue)
+	{
+		mystack.push_back(QueryContext::DfsFrame(start->getIndex(),
+			start->getAdjacencyList().begin()));
+		GRAPH_COUNT(counters, neighborResets, 1);
+	}
+
+	while (!mystack.empty() && control != TraversalControl::Stop)
+	{
+		//find unvisited neighbor, frame remembers where we stopped
+		QueryContext::DfsFrame& top = mystack.back();
+		const Vertex* current = vertexList[top.first];
+		const Vertex* neighbor = nullptr;
+		while (top.second != current->getAdjacencyList().end())
+		{
+			const Vertex* next = vertexList[top.second->getEndVertex()];
+			GRAPH_COUNT(counters, vertexLookups, 1);
+			top.second++;
+			if (!context.isVisited(next->getIndex()))
+			{
+				neighbor = next;
+				break;
+			}
+		}
+
+		if (neighbor != nullptr)
+		{
+			context.visit(neighbor->getIndex());
+			control = callVisitor(visitor, TraversalVisit(
+				neighbor->getIndex(), neighbor->getLabel(),
+				static_cast<int>(mystack.size())));
+			if (control == TraversalControl::Continue)
+			{
+				mystack.push_back(QueryContext::DfsFrame(
+					neighbor->getIndex(),
+					neighbor->getAdjacencyList().begin()));
+				GRAPH_COUNT(counters, neighborResets, 1);
+				GRAPH_COUNT_MAX(counters, frontierHighWater,
+					static_cast<long long>(mystack.size()));
+			}
+		}
+		else
+			mystack.pop_back();
+	}
+	recordQuery(context);
+}
+
+/** helper for breadthFirstTraversal, every overload ends up here
+frontier is a vector, head moves forward instead of popping
+levelEnd marks where the vertices one edge further away start */
+template <typename Visitor>
+void Graph::breadthFirstTraversalHelper(const Vertex* start,
+	Visitor& visitor, QueryContext& context) const
+{
+	std::vector<int>& myqueue = context.getFrontier();
+	QueryCounters& counters = context.getCounters();
+	context.beginQuery(numberOfVertices);
+
+	context.visit(start->getIndex());
+	TraversalControl control = callVisitor(visitor,
+		TraversalVisit(start->getIndex(), start->getLabel(), 0));
+	if (control == TraversalControl::Continue)
+		myqueue.push_back(start->getIndex());
+
+	size_t levelEnd = myqueue.size();
+	int depth = 0;
+	for (size_t head = 0; head < myqueue.size(); head++)
+	{
+		if (head == levelEnd)
+		{
+			depth++;
+			levelEnd = myqueue.size();
+		}
+		const Vertex* currentVertex = vertexList[myqueue[head]];
+		GRAPH_COUNT(counters, neighborResets, 1);
+		for (Vertex::AdjacencyList::const_iterator it =
+			currentVertex->getAdjacencyList().begin(),
+			it_end = currentVertex->getAdjacencyList().end();
+			it != it_end; it++)
+		{
+			const Vertex* neighbor = vertexList[it->getEndVertex()];
+			GRAPH_COUNT(counters, vertexLookups, 1);
+			if (context.isVisited(neighbor->getIndex()))
+				continue;
+			context.visit(neighbor->getIndex());
+			control = callVisitor(visitor, TraversalVisit(
+				neighbor->getIndex(), neighbor->getLabel(), depth + 1));
+			if (control == TraversalControl::Stop)
+				break;
+			if (control == TraversalControl::Continue)
+			{
+				myqueue.push_back(neighbor->getIndex());
+				GRAPH_COUNT_MAX(counters, frontierHighWater,
+					static_cast<long long>(myqueue.size() - head));
+			}
+		}
+		if (control == TraversalControl::Stop)
+			break;
+	}
+	recordQuery(context);
+}
+
 #endif  // GRAPH_H
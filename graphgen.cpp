@@ -0,0 +1,214 @@
+// File Name: graphgen.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "graphgen.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** mix seed and chunk number into a well spread seed, splitmix64 */
+static unsigned long long chunkSeed(unsigned long long seed,
+	long long chunk)
+{
+	unsigned long long z = seed + 0x9E3779B97F4A7C15ULL *
+		(static_cast<unsigned long long>(chunk) + 1);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/** generator for about numVertices vertices
+numEdges is used by RMat and ErdosRenyi, Grid and Chain have a
+fixed number of edges for their size */
+GraphGenerator::GraphGenerator(Topology topology, long long numVertices,
+	long long numEdges, unsigned long long seed)
+{
+	shape = topology;
+	vertexCount = numVertices < 2 ? 2 : numVertices;
+	edgeCount = numEdges < 0 ? 0 : numEdges;
+	baseSeed = seed;
+	if (shape == Topology::Grid)
+	{
+		gridCols = static_cast<long long>(
+			std::ceil(std::sqrt(static_cast<double>(vertexCount))));
+		gridRows = (vertexCount + gridCols - 1) / gridCols;
+		vertexCount = gridRows * gridCols;
+		// each neighboring pair of cells is connected both ways
+		edgeCount = 2 * (gridRows * (gridCols - 1) +
+			(gridRows - 1) * gridCols);
+	}
+	else if (shape == Topology::Chain)
+		edgeCount = vertexCount - 1;
+}
+
+/** number of threads making edges, default 1 */
+void GraphGenerator::setThreads(int threads)
+{ threadCount = threads < 1 ? 1 : threads; }
+
+/** weights are uniform in 1..maxWeight, default 100, Chain uses 1 */
+void GraphGenerator::setMaxWeight(int maxWeight)
+{ weightLimit = maxWeight < 1 ? 1 : maxWeight; }
+
+/** return the label of vertex number v */
+std::string GraphGenerator::label(long long v)
+{ return "v" + std::to_string(v); }
+
+/** return number of vertices, Grid rounds up to whole rows */
+long long GraphGenerator::getNumVertices() const { return vertexCount; }
+
+/** return number of edges that will be generated */
+long long GraphGenerator::getNumEdges() const { return edgeCount; }
+
+/** return number of chunks */
+long long GraphGenerator::getNumChunks() const
+{ return (edgeCount + chunkSize - 1) / chunkSize; }
+
+/** add every edge to graph
+edges go to Graph::addEdges in batches that grow with the graph, so
+the hubs RMat makes are merged a few times rather than per edge */
+void GraphGenerator::generate(Graph& graph) const
+{
+	std::vector<LabeledEdge> batch;
+	forEachEdge([&graph, &batch](const GeneratedEdge& e) {
+		batch.push_back(LabeledEdge{ label(e.from), label(e.to), e.weight });
+		if (batch.size() >= std::max<size_t>(1 << 16,
+			static_cast<size_t>(graph.getNumEdges()) / 2))
+		{
+			graph.addEdges(batch);
+			batch.clear();
+		}
+	});
+	graph.addEdges(batch);
+}
+
+/** write every edge to filename in the readFile format
+the first line is the edge count
+memory use is one chunk of text per thread
+@return  false if the file could not be written */
+bool GraphGenerator::writeFile(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::out | std::ios::trunc);
+	if (!out.is_open())
+	{
+		std::cerr << "Could not open file: " << filename;
+		return false;
+	}
+	out << edgeCount << "\n";
+
+	// threads generate and format, this thread writes in chunk order
+	std::vector<std::vector<GeneratedEdge>> edges(threadCount);
+	std::vector<std::string> text(threadCount);
+	runChunks(
+		[this, &edges, &text](long long chunk, int slot) {
+			generateChunk(chunk, edges[slot]);
+			std::string& buffer = text[slot];
+			buffer.clear();
+			char line[80];
+			for (const GeneratedEdge& e : edges[slot])
+			{
+				int length = std::snprintf(line, sizeof(line),
+					"v%lld   v%lld   %d\n", e.from, e.to, e.weight);
+				buffer.append(line, static_cast<size_t>(length));
+			}
+		},
+		[&out, &text](int slot) {
+			out.write(text[slot].data(),
+				static_cast<std::streamsize>(text[slot].size()));
+		});
+	return static_cast<bool>(out);
+}
+
+/** make the edges of one chunk into edges, replacing its contents */
+void GraphGenerator::generateChunk(long long chunk,
+	std::vector<GeneratedEdge>& edges) const
+{
+	long long first = chunk * chunkSize;
+	long long last = std::min(edgeCount, first + chunkSize);
+	std::mt19937_64 rng(chunkSeed(baseSeed, chunk));
+	std::uniform_int_distribution<int> weight(1, weightLimit);
+	std::uniform_int_distribution<long long> anyVertex(0, vertexCount - 1);
+	edges.clear();
+	edges.reserve(static_cast<size_t>(last - first));
+
+	// RMat quadrant probabilities, a b c d = 0.57 0.19 0.19 0.05
+	int scale = 0;
+	while ((1LL << scale) < vertexCount)
+		scale++;
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+	for (long long k = first; k < last; k++)
+	{
+		long long from = 0;
+		long long to = 0;
+		switch (shape)
+		{
+		case Topology::Chain:
+			edges.push_back(GeneratedEdge(k, k + 1, 1));
+			continue;
+		case Topology::Grid:
+		{
+			// edge pair p, direction k % 2, horizontal pairs first
+			long long p = k / 2;
+			long long horizontal = gridRows * (gridCols - 1);
+			if (p < horizontal)
+			{
+				long long row = p / (gridCols - 1);
+				long long col = p % (gridCols - 1);
+				from = row * gridCols + col;
+				to = from + 1;
+			}
+			else
+			{
+				from = p - horizontal;
+				to = from + gridCols;
+			}
+			if (k % 2 == 1)
+				std::swap(from, to);
+			break;
+		}
+		case Topology::ErdosRenyi:
+			do
+			{
+				from = anyVertex(rng);
+				to = anyVertex(rng);
+			} while (from == to);
+			break;
+		case Topology::RMat:
+			do
+			{
+				from = 0;
+				to = 0;
+				for (int bit = scale - 1; bit >= 0; bit--)
+				{
+					double r = unit(rng);
+					if (r >= 0.57 && r < 0.76)
+						to |= 1LL << bit;
+					else if (r >= 0.76 && r < 0.95)
+						from |= 1LL << bit;
+					else if (r >= 0.95)
+					{
+						from |= 1LL << bit;
+						to |= 1LL << bit;
+					}
+				}
+			} while (from == to || from >= vertexCount ||
+				to >= vertexCount);
+			break;
+		}
+		edges.push_back(GeneratedEdge(from, to, weight(rng)));
+	}
+}
@@ -0,0 +1,146 @@
+/**
+* Synthetic graphs for load testing, at any scale
+* RMat        power-law graph, a few vertices with very many edges
+* Grid        road-like 2D grid, each cell connected both ways to
+*             the cells right of and below it
+* ErdosRenyi  numEdges edges between uniformly random vertices
+* Chain       v0 -> v1 -> ... a single deep path, like graph1.txt
+* Vertices are labelled v0, v1, ...
+* Edges are made in chunks, each chunk with its own random generator
+* seeded from seed and the chunk number, so the output depends only on
+* the seed and never on the number of threads
+* Duplicate edges can appear in RMat and ErdosRenyi, Graph::add
+* ignores them, self loops are never generated
+*/
+
+#ifndef GRAPHGEN_H
+#define GRAPHGEN_H
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Graph;
+
+/** one generated edge, vertex numbers rather than labels */
+class GeneratedEdge {
+public:
+	GeneratedEdge() {}
+	GeneratedEdge(long long fromVertex, long long toVertex, int edgeWeight)
+		: from(fromVertex), to(toVertex), weight(edgeWeight) {}
+
+	long long from{ 0 };
+	long long to{ 0 };
+	int weight{ 0 };
+};  // end GeneratedEdge
+
+class GraphGenerator {
+public:
+	/** shape of the generated graph */
+	enum class Topology { RMat, Grid, ErdosRenyi, Chain };
+
+	/** generator for about numVertices vertices
+	numEdges is used by RMat and ErdosRenyi, Grid and Chain have a
+	fixed number of edges for their size */
+	GraphGenerator(Topology topology, long long numVertices,
+		long long numEdges, unsigned long long seed);
+
+	/** number of threads making edges, default 1 */
+	void setThreads(int threads);
+
+	/** weights are uniform in 1..maxWeight, default 100, Chain uses 1 */
+	void setMaxWeight(int maxWeight);
+
+	/** return the label of vertex number v */
+	static std::string label(long long v);
+
+	/** return number of vertices, Grid rounds up to whole rows */
+	long long getNumVertices() const;
+
+	/** return number of edges that will be generated */
+	long long getNumEdges() const;
+
+	/** add every edge to graph */
+	void generate(Graph& graph) const;
+
+	/** write every edge to filename in the readFile format
+	the first line is the edge count
+	memory use is one chunk of text per thread
+	@return  false if the file could not be written */
+	bool writeFile(const std::string& filename) const;
+
+	/** call fn(const GeneratedEdge&) on every edge, in order
+	chunks are made in parallel, fn is called from this thread only */
+	template <typename Fn>
+	void forEachEdge(Fn&& fn) const;
+
+private:
+	/** make the edges of one chunk into edges, replacing its contents */
+	void generateChunk(long long chunk,
+		std::vector<GeneratedEdge>& edges) const;
+
+	/** run work(chunk, slot) for every chunk, threads chunks at a time,
+	then consume(slot) for each of them in chunk order */
+	template <typename Work, typename Consume>
+	void runChunks(Work work, Consume consume) const;
+
+	/** return number of chunks */
+	long long getNumChunks() const;
+
+	Topology shape;
+	long long vertexCount;
+	long long edgeCount;
+	unsigned long long baseSeed;
+	int threadCount{ 1 };
+	int weightLimit{ 100 };
+
+	/** Grid dimensions */
+	long long gridRows{ 0 };
+	long long gridCols{ 0 };
+
+	/** edges per chunk */
+	static const long long chunkSize = 1 << 16;
+};  // end GraphGenerator
+
+/** call fn(const GeneratedEdge&) on every edge, in order */
+template <typename Fn>
+void GraphGenerator::forEachEdge(Fn&& fn) const
+{
+	std::vector<std::vector<GeneratedEdge>> buffers(threadCount);
+	runChunks(
+		[this, &buffers](long long chunk, int slot) {
+			generateChunk(chunk, buffers[slot]);
+		},
+		[&buffers, &fn](int slot) {
+			for (const GeneratedEdge& e : buffers[slot])
+				fn(e);
+		});
+}
+
+/** run work(chunk, slot) for every chunk, threads chunks at a time,
+then consume(slot) for each of them in chunk order */
+template <typename Work, typename Consume>
+void GraphGenerator::runChunks(Work work, Consume consume) const
+{
+	long long numChunks = getNumChunks();
+	for (long long first = 0; first < numChunks; first += threadCount)
+	{
+		int count = static_cast<int>(
+			std::min<long long>(threadCount, numChunks - first));
+		if (count == 1)
+			work(first, 0);
+		else
+		{
+			std::vector<std::thread> workers;
+			for (int slot = 0; slot < count; slot++)
+				workers.emplace_back(work, first + slot, slot);
+			for (std::thread& worker : workers)
+				worker.join();
+		}
+		for (int slot = 0; slot < count; slot++)
+			consume(slot);
+	}
+}
+
+#endif  // GRAPHGEN_H
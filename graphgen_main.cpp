@@ -0,0 +1,50 @@
+//FileName: graphgen_main.cpp
+//Command line front end for GraphGenerator
+//Date: February 1, 2018
+//
+// graphgen topology vertices edges seed file [threads] [maxWeight]
+//   topology is rmat, grid, er or chain
+//   edges is ignored by grid and chain
+// writes file in the readFile format, for example
+//   graphgen rmat 1000000 16000000 42 rmat20.txt 8
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "graphgen.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+	if (argc < 6) {
+		cerr << "usage: graphgen rmat|grid|er|chain vertices edges seed "
+			<< "file [threads] [maxWeight]" << endl;
+		return 1;
+	}
+	string name = argv[1];
+	GraphGenerator::Topology topology;
+	if (name == "rmat")
+		topology = GraphGenerator::Topology::RMat;
+	else if (name == "grid")
+		topology = GraphGenerator::Topology::Grid;
+	else if (name == "er")
+		topology = GraphGenerator::Topology::ErdosRenyi;
+	else if (name == "chain")
+		topology = GraphGenerator::Topology::Chain;
+	else {
+		cerr << "unknown topology: " << name << endl;
+		return 1;
+	}
+	GraphGenerator generator(topology, atoll(argv[2]), atoll(argv[3]),
+		strtoull(argv[4], nullptr, 10));
+	if (argc > 6)
+		generator.setThreads(atoi(argv[6]));
+	if (argc > 7)
+		generator.setMaxWeight(atoi(argv[7]));
+	if (!generator.writeFile(argv[5]))
+		return 1;
+	cout << generator.getNumVertices() << " vertices "
+		<< generator.getNumEdges() << " edges" << endl;
+	return 0;
+}
@@ -0,0 +1,509 @@
+// File Name: graphjournal.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "graphjournal.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+static const char checkpointMagic[8] = { 'G', 'C', 'H', 'E', 'C', 'K', '1', 0 };
+static const char journalMagic[8] = { 'G', 'J', 'O', 'U', 'R', 'N', '1', 0 };
+
+/** magic and generation */
+static const size_t headerBytes = 16;
+
+/** record types */
+static const uint8_t addRecord = 1;
+static const uint8_t removeRecord = 2;
+static const uint8_t updateRecord = 3;
+
+/** checkpoint bytes collected before writing them out */
+static const size_t checkpointBuffer = 1 << 20;
+
+/** read a whole file into bytes
+@return  false if it does not exist or cannot be read */
+static bool readWholeFile(const std::string& path,
+	std::vector<uint8_t>& bytes)
+{
+	std::ifstream in(path, std::ios::in | std::ios::binary);
+	if (!in.is_open())
+		return false;
+	bytes.assign(std::istreambuf_iterator<char>(in),
+		std::istreambuf_iterator<char>());
+	return !in.bad();
+}
+
+/** return true if bytes start with magic, generation goes in generation */
+static bool readHeader(const std::vector<uint8_t>& bytes, const char* magic,
+	uint64_t& generation)
+{
+	if (bytes.size() < headerBytes || std::memcmp(bytes.data(), magic, 8) != 0)
+		return false;
+	generation = 0;
+	for (int i = 7; i >= 0; i--)
+		generation = (generation << 8) | bytes[8 + i];
+	return true;
+}
+
+/** rename from over to, replacing it
+Windows will not rename over an existing file, there it is removed
+first, which is the one moment a crash leaves neither */
+static bool renameOver(const std::string& from, const std::string& to)
+{
+	if (std::rename(from.c_str(), to.c_str()) == 0)
+		return true;
+	std::remove(to.c_str());
+	return std::rename(from.c_str(), to.c_str()) == 0;
+}
+
+/** zigzag, small negative weights stay small */
+static uint64_t zigzag(int value)
+{
+	return value < 0 ? (static_cast<uint64_t>(-(value + 1)) << 1) | 1 :
+		static_cast<uint64_t>(value) << 1;
+}
+
+static int unzigzag(uint64_t value)
+{
+	return (value & 1) != 0 ? -static_cast<int>(value >> 1) - 1 :
+		static_cast<int>(value >> 1);
+}
+
+/** constructor, use basename.checkpoint and basename.journal
+nothing is read until recover */
+GraphJournal::GraphJournal(const std::string& basename)
+	: checkpointPath(basename + ".checkpoint"),
+	journalPath(basename + ".journal") {}
+
+/** destructor, flushes and stops recording the graph */
+GraphJournal::~GraphJournal()
+{
+	flush();
+	if (graph != nullptr)
+		graph->journal = nullptr;
+}
+
+/** load the checkpoint into graph, replay the journal on top, then
+record every later change of graph
+the checkpoint is checked before anything is added, the journal is
+replayed up to the first record that does not read back whole */
+bool GraphJournal::recover(Graph& target)
+{
+	if (graph != nullptr || target.journal != nullptr ||
+		target.getNumVertices() != 0)
+		return false;
+	replayed = 0;
+	records = 0;
+	if (!loadCheckpoint(target) || !replay(target))
+		return false;
+	journal.open(journalPath,
+		std::ios::out | std::ios::binary | std::ios::app);
+	if (!journal.is_open())
+		return false;
+	healthy = true;
+	graph = &target;
+	graph->journal = this;
+	return true;
+}
+
+/** write the whole graph as a new checkpoint and start an empty
+journal, the graph keeps being recorded
+the checkpoint is renamed into place first, once it is there the old
+journal has an older generation and is ignored, so if replacing it
+fails nothing more can be recorded and the journal is unhealthy
+the generation moves on only once the new journal is in place */
+bool GraphJournal::checkpoint()
+{
+	if (graph == nullptr)
+		return false;
+	flush();
+	uint64_t next = generation + 1;
+	std::string tmpPath = checkpointPath + ".tmp";
+	std::ofstream out(tmpPath,
+		std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+		return false;
+
+	// labels in index order, then the edges of each vertex
+	std::vector<uint8_t> bytes;
+	putHeader(bytes, checkpointMagic, next);
+	int numVertices = graph->numberOfVertices;
+	putVarint(bytes, static_cast<uint64_t>(numVertices));
+	putVarint(bytes, static_cast<uint64_t>(graph->numberOfEdges));
+	for (int v = 0; v < numVertices; v++)
+	{
+		const std::string& label = graph->vertexList[v]->getLabel();
+		putVarint(bytes, label.size());
+		bytes.insert(bytes.end(), label.begin(), label.end());
+		if (bytes.size() >= checkpointBuffer)
+		{
+			out.write(reinterpret_cast<const char*>(bytes.data()),
+				static_cast<std::streamsize>(bytes.size()));
+			bytes.clear();
+		}
+	}
+	for (int v = 0; v < numVertices; v++)
+	{
+		const Vertex::AdjacencyList& edges =
+			graph->vertexList[v]->getAdjacencyList();
+		putVarint(bytes, edges.size());
+		for (size_t e = 0; e < edges.size(); e++)
+		{
+			putVarint(bytes, static_cast<uint64_t>(edges[e].getEndVertex()));
+			putVarint(bytes, zigzag(edges[e].getWeight()));
+		}
+		if (bytes.size() >= checkpointBuffer)
+		{
+			out.write(reinterpret_cast<const char*>(bytes.data()),
+				static_cast<std::streamsize>(bytes.size()));
+			bytes.clear();
+		}
+	}
+	out.write(reinterpret_cast<const char*>(bytes.data()),
+		static_cast<std::streamsize>(bytes.size()));
+	out.close();
+	if (!out || !renameOver(tmpPath, checkpointPath))
+		return false;
+
+	// the journal is closed while it is replaced, Windows needs that
+	records = 0;
+	unflushed = 0;
+	journal.close();
+	journal.clear();
+	std::vector<uint8_t> header;
+	putHeader(header, journalMagic, next);
+	if (replaceFile(journalPath, header))
+		journal.open(journalPath,
+			std::ios::out | std::ios::binary | std::ios::app);
+	healthy = journal.is_open();
+	if (healthy)
+		generation = next;
+	return healthy;
+}
+
+/** checkpoint by itself after this many records, 0 never */
+void GraphJournal::setCheckpointInterval(long long records)
+{ checkpointInterval = records < 0 ? 0 : records; }
+
+/** flush to the operating system every this many records */
+void GraphJournal::setFlushInterval(int records)
+{ flushInterval = records < 1 ? 1 : records; }
+
+/** write buffered records to the operating system
+a failed write or flush makes the journal unhealthy */
+void GraphJournal::flush()
+{
+	if (journal.is_open())
+	{
+		journal.flush();
+		if (!journal)
+			healthy = false;
+	}
+	unflushed = 0;
+}
+
+/** return false once a record could not be written */
+bool GraphJournal::isHealthy() const { return healthy; }
+
+/** return number of records in the journal since the checkpoint */
+long long GraphJournal::getRecordCount() const { return records; }
+
+/** return number of records the last recover replayed */
+long long GraphJournal::getReplayedCount() const { return replayed; }
+
+/** return the generation, one more for every checkpoint */
+uint64_t GraphJournal::getGeneration() const { return generation; }
+
+/** record an add that created vertices or an edge */
+void GraphJournal::recordAdd(int start, int end, int weight, int firstNew)
+{
+	record.clear();
+	record.push_back(addRecord);
+	putVertex(start, firstNew);
+	putVertex(end, firstNew);
+	putVarint(record, zigzag(weight));
+	endRecord();
+}
+
+/** record a removed edge, both vertices already existed */
+void GraphJournal::recordRemove(int start, int end)
+{
+	record.clear();
+	record.push_back(removeRecord);
+	putVertex(start, graph->numberOfVertices);
+	putVertex(end, graph->numberOfVertices);
+	endRecord();
+}
+
+/** record a changed weight, both vertices already existed */
+void GraphJournal::recordUpdate(int start, int end, int weight)
+{
+	record.clear();
+	record.push_back(updateRecord);
+	putVertex(start, graph->numberOfVertices);
+	putVertex(end, graph->numberOfVertices);
+	putVarint(record, zigzag(weight));
+	endRecord();
+}
+
+/** the graph is being destroyed, stop recording it */
+void GraphJournal::detach()
+{
+	flush();
+	graph = nullptr;
+}
+
+/** append a vertex reference to record
+vertices created by the record are written as labels, replaying the
+add creates them again with the same index */
+void GraphJournal::putVertex(int index, int firstNew)
+{
+	if (index < firstNew)
+	{
+		putVarint(record, static_cast<uint64_t>(index) << 1);
+		return;
+	}
+	const std::string& label = graph->vertexList[index]->getLabel();
+	putVarint(record, (static_cast<uint64_t>(label.size()) << 1) | 1);
+	record.insert(record.end(), label.begin(), label.end());
+}
+
+/** finish a record, flush or checkpoint when it is time
+an unhealthy journal writes nothing, only a checkpoint can save the
+changes made since, a failed automatic checkpoint is retried after
+the next record */
+void GraphJournal::endRecord()
+{
+	if (!healthy)
+		return;
+	journal.write(reinterpret_cast<const char*>(record.data()),
+		static_cast<std::streamsize>(record.size()));
+	if (!journal)
+	{
+		healthy = false;
+		return;
+	}
+	records++;
+	if (++unflushed >= flushInterval)
+		flush();
+	if (healthy && checkpointInterval > 0 && records >= checkpointInterval)
+		checkpoint();
+}
+
+/** read the checkpoint into an empty graph
+everything is read and checked first, so a damaged checkpoint leaves
+the graph empty, a missing one is generation 0 */
+bool GraphJournal::loadCheckpoint(Graph& target)
+{
+	generation = 0;
+	std::vector<uint8_t> bytes;
+	if (!readWholeFile(checkpointPath, bytes))
+		return true;
+	if (!readHeader(bytes, checkpointMagic, generation))
+		return false;
+
+	size_t pos = headerBytes;
+	uint64_t numVertices;
+	uint64_t numEdges;
+	if (!getVarint(bytes, pos, numVertices) ||
+		!getVarint(bytes, pos, numEdges) || numVertices > bytes.size())
+		return false;
+	std::vector<std::string> labels(static_cast<size_t>(numVertices));
+	for (size_t v = 0; v < labels.size(); v++)
+	{
+		uint64_t length;
+		if (!getVarint(bytes, pos, length) || length > bytes.size() - pos)
+			return false;
+		labels[v].assign(reinterpret_cast<const char*>(&bytes[pos]),
+			static_cast<size_t>(length));
+		pos += static_cast<size_t>(length);
+	}
+	std::vector<long long> offsets(labels.size() + 1, 0);
+	std::vector<int> targets;
+	std::vector<int> weights;
+	for (size_t v = 0; v < labels.size(); v++)
+	{
+		uint64_t degree;
+		if (!getVarint(bytes, pos, degree) || degree > bytes.size() - pos)
+			return false;
+		for (uint64_t e = 0; e < degree; e++)
+		{
+			uint64_t to;
+			uint64_t weight;
+			if (!getVarint(bytes, pos, to) || to >= numVertices ||
+				!getVarint(bytes, pos, weight))
+				return false;
+			targets.push_back(static_cast<int>(to));
+			weights.push_back(unzigzag(weight));
+		}
+		offsets[v + 1] = static_cast<long long>(targets.size());
+	}
+	if (targets.size() != numEdges)
+		return false;
+	std::vector<const std::string*> sorted;
+	for (size_t v = 0; v < labels.size(); v++)
+		sorted.push_back(&labels[v]);
+	auto less = [](const std::string* a, const std::string* b)
+	{ return *a < *b; };
+	auto same = [](const std::string* a, const std::string* b)
+	{ return *a == *b; };
+	std::sort(sorted.begin(), sorted.end(), less);
+	if (std::adjacent_find(sorted.begin(), sorted.end(), same) !=
+		sorted.end())
+		return false;
+
+	// labels in index order give every vertex its old index back
+	for (size_t v = 0; v < labels.size(); v++)
+		target.findOrCreateVertex(labels[v]);
+	// each list is merged in once, connect one by one is O(degree^2)
+	std::vector<Edge> edges;
+	for (size_t v = 0; v < labels.size(); v++)
+	{
+		edges.clear();
+		for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+			edges.push_back(Edge(targets[e], weights[e]));
+		target.numberOfEdges +=
+			target.vertexList[v]->connectAll(edges, target.vertexList);
+		for (size_t e = 0; e < edges.size(); e++)
+			if (edges[e].getWeight() < 0)
+				target.negativeEdges++;
+	}
+	target.edgesChanged();
+	return true;
+}
+
+/** replay journal records of the current generation
+a journal from an older generation or none at all is replaced by an
+empty one, a record cut off at the end is cut from the file */
+bool GraphJournal::replay(Graph& target)
+{
+	std::vector<uint8_t> bytes;
+	uint64_t journalGeneration = 0;
+	bool found = readWholeFile(journalPath, bytes);
+	if (found && !readHeader(bytes, journalMagic, journalGeneration))
+		return false;
+	if (found && journalGeneration > generation)
+		return false;  // its checkpoint is gone
+	if (!found || journalGeneration < generation)
+	{
+		std::vector<uint8_t> header;
+		putHeader(header, journalMagic, generation);
+		return replaceFile(journalPath, header);
+	}
+
+	size_t pos = headerBytes;
+	size_t good = pos;
+	while (pos < bytes.size())
+	{
+		uint8_t type = bytes[pos++];
+		if (type != addRecord && type != removeRecord &&
+			type != updateRecord)
+			break;
+		std::string labels[2];
+		bool whole = true;
+		for (int i = 0; i < 2 && whole; i++)
+		{
+			uint64_t ref;
+			whole = getVarint(bytes, pos, ref);
+			if (whole && (ref & 1) == 0)
+			{
+				whole = (ref >> 1) <
+					static_cast<uint64_t>(target.getNumVertices());
+				if (whole)
+					labels[i] = target.getVertexLabel(
+						static_cast<int>(ref >> 1));
+			}
+			else if (whole)
+			{
+				whole = (ref >> 1) <= bytes.size() - pos;
+				if (whole)
+				{
+					labels[i].assign(
+						reinterpret_cast<const char*>(&bytes[pos]),
+						static_cast<size_t>(ref >> 1));
+					pos += static_cast<size_t>(ref >> 1);
+				}
+			}
+		}
+		uint64_t weight = 0;
+		if (!whole || (type != removeRecord && !getVarint(bytes, pos, weight)))
+			break;
+		bool known = target.getVertexIndex(labels[0]) != -1;
+		if (type == addRecord)
+			target.add(labels[0], labels[1], unzigzag(weight));
+		else if (known && type == removeRecord)
+			target.removeEdge(labels[0], labels[1]);
+		else if (known)
+			target.updateWeight(labels[0], labels[1], unzigzag(weight));
+		replayed++;
+		good = pos;
+	}
+	records = replayed;
+	if (good == bytes.size())
+		return true;
+	bytes.resize(good);
+	return replaceFile(journalPath, bytes);
+}
+
+/** write bytes to path.tmp and rename it over path */
+bool GraphJournal::replaceFile(const std::string& path,
+	const std::vector<uint8_t>& bytes)
+{
+	std::string tmpPath = path + ".tmp";
+	std::ofstream out(tmpPath,
+		std::ios::out | std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char*>(bytes.data()),
+		static_cast<std::streamsize>(bytes.size()));
+	out.close();
+	return out && renameOver(tmpPath, path);
+}
+
+/** a file header, magic then generation */
+void GraphJournal::putHeader(std::vector<uint8_t>& out, const char* magic,
+	uint64_t generation)
+{
+	out.insert(out.end(), magic, magic + 8);
+	for (int i = 0; i < 8; i++)
+		out.push_back(static_cast<uint8_t>(generation >> (8 * i)));
+}
+
+/** append value as a varint to out */
+void GraphJournal::putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+/** read a varint at in[pos], move pos past it
+@return  false if in ends first or it is too long */
+bool GraphJournal::getVarint(const std::vector<uint8_t>& in, size_t& pos,
+	uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+	{
+		uint8_t b = in[pos++];
+		value |= static_cast<uint64_t>(b & 0x7f) << shift;
+		if ((b & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,165 @@
+/**
+* Write-ahead journal of every Graph::add, Graph::removeEdge and weight
+* update, with checkpoints of the whole graph, so a restarted process
+* gets its edits back by loading the last checkpoint and replaying the
+* journal
+*
+* Files, both binary and little-endian:
+*   basename.checkpoint  every vertex label in index order, then every
+*                        vertex's edges, the indices come back the same
+*   basename.journal     the changes made since that checkpoint
+* Both start with the same generation number, a checkpoint starts a
+* new generation, a journal from an older one is already part of the
+* checkpoint and is not replayed
+* Files are replaced by writing a .tmp file and renaming it, so a crash
+* leaves either the old or the new one
+*
+* Journal records, one per change:
+*   add     byte 1, start, end, weight zigzag varint
+*   remove  byte 2, start, end
+*   update  byte 3, start, end, new weight zigzag varint
+* a vertex is its index as varint index * 2, or when the record
+* created it, its label as varint length * 2 + 1 then the bytes
+* A record cut off by a crash is dropped on recovery
+*
+* Records are written before the change returns, flushed to the
+* operating system every setFlushInterval records, default every one,
+* which survives the process dying but not the machine
+* A record that cannot be written makes the journal unhealthy, later
+* changes are not recorded until a checkpoint succeeds, check
+* isHealthy after changes that must not be lost
+*/
+
+#ifndef GRAPHJOURNAL_H
+#define GRAPHJOURNAL_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Graph;
+
+class GraphJournal {
+public:
+	/** constructor, use basename.checkpoint and basename.journal
+	nothing is read until recover */
+	explicit GraphJournal(const std::string& basename);
+
+	/** destructor, flushes and stops recording the graph */
+	~GraphJournal();
+
+	GraphJournal(const GraphJournal&) = delete;
+	GraphJournal& operator=(const GraphJournal&) = delete;
+
+	/** load the checkpoint into graph, replay the journal on top, then
+	record every later change of graph
+	missing files are an empty graph, the first run creates them
+	@return  false, graph unchanged, if graph is not empty, is already
+	journaled, or a file is damaged or cannot be written */
+	bool recover(Graph& graph);
+
+	/** write the whole graph as a new checkpoint and start an empty
+	journal, the graph keeps being recorded, and makes an unhealthy
+	journal healthy again
+	@return  false if no graph is recorded or a file cannot be written,
+	if the checkpoint could not be written the old checkpoint and
+	journal are still good, if the new journal could not be started
+	the journal is unhealthy */
+	bool checkpoint();
+
+	/** checkpoint by itself after this many records, 0 never */
+	void setCheckpointInterval(long long records);
+
+	/** flush to the operating system every this many records, at
+	least 1, larger batches are faster and lose more in a crash */
+	void setFlushInterval(int records);
+
+	/** write buffered records to the operating system */
+	void flush();
+
+	/** return false once a record could not be written, the changes
+	since then are only in memory until a checkpoint succeeds */
+	bool isHealthy() const;
+
+	/** return number of records in the journal since the checkpoint */
+	long long getRecordCount() const;
+
+	/** return number of records the last recover replayed */
+	long long getReplayedCount() const;
+
+	/** return the generation, one more for every checkpoint */
+	uint64_t getGeneration() const;
+
+private:
+	/** Graph's changes record through these */
+	friend class Graph;
+
+	/** record an add that created vertices or an edge
+	vertices with index firstNew or higher were created by it */
+	void recordAdd(int start, int end, int weight, int firstNew);
+
+	/** record a removed edge */
+	void recordRemove(int start, int end);
+
+	/** record a changed weight */
+	void recordUpdate(int start, int end, int weight);
+
+	/** the graph is being destroyed, stop recording it */
+	void detach();
+
+	/** append a vertex reference to record */
+	void putVertex(int index, int firstNew);
+
+	/** finish a record, flush or checkpoint when it is time */
+	void endRecord();
+
+	/** read the checkpoint into an empty graph
+	@return  false if it is damaged, missing is fine */
+	bool loadCheckpoint(Graph& graph);
+
+	/** replay journal records of the current generation, drop a
+	record cut off at the end
+	@return  false if the journal cannot be read or repaired */
+	bool replay(Graph& graph);
+
+	/** write bytes to path.tmp and rename it over path */
+	static bool replaceFile(const std::string& path,
+		const std::vector<uint8_t>& bytes);
+
+	/** a file header, magic then generation */
+	static void putHeader(std::vector<uint8_t>& out, const char* magic,
+		uint64_t generation);
+
+	/** append value as a varint to out */
+	static void putVarint(std::vector<uint8_t>& out, uint64_t value);
+
+	/** read a varint at in[pos], move pos past it
+	@return  false if in ends first */
+	static bool getVarint(const std::vector<uint8_t>& in, size_t& pos,
+		uint64_t& value);
+
+	std::string checkpointPath;
+	std::string journalPath;
+
+	/** graph being recorded, nullptr before recover */
+	Graph* graph{ nullptr };
+
+	/** journal opened for appending after recover */
+	std::ofstream journal;
+
+	/** the record being built */
+	std::vector<uint8_t> record;
+
+	uint64_t generation{ 0 };
+	long long records{ 0 };
+	long long replayed{ 0 };
+	long long checkpointInterval{ 0 };
+	int flushInterval{ 1 };
+	int unflushed{ 0 };
+
+	/** false once a write failed, see isHealthy */
+	bool healthy{ true };
+};  // end GraphJournal
+
+#endif  // GRAPHJOURNAL_H
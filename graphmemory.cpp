@@ -0,0 +1,72 @@
+// File Name: graphmemory.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <cstdio>
+#include <string>
+
+#include "graphmemory.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** return the sum of all parts */
+size_t GraphMemoryUsage::totalBytes() const
+{
+	return vertexMapBytes + vertexObjectBytes + labelBytes +
+		adjacencyNodeBytes + edgePayloadBytes;
+}
+
+/** return totalBytes divided by edges, 0 for no edges */
+double GraphMemoryUsage::bytesPerEdge() const
+{
+	return edges == 0 ? 0.0 : static_cast<double>(totalBytes()) / edges;
+}
+
+/** return a readable table of the parts, one per line */
+std::string GraphMemoryUsage::report() const
+{
+	struct Line { const char* name; size_t bytes; };
+	Line lines[] = {
+		{ "label index", vertexMapBytes },
+		{ "vertex objects", vertexObjectBytes },
+		{ "label strings", labelBytes },
+		{ "adjacency overhead", adjacencyNodeBytes },
+		{ "edge payloads", edgePayloadBytes },
+		{ "total", totalBytes() } };
+	std::string out;
+	char buffer[96];
+	for (const Line& line : lines)
+	{
+		double share = totalBytes() == 0 ? 0.0 :
+			100.0 * line.bytes / totalBytes();
+		std::snprintf(buffer, sizeof(buffer), "%-16s %14zu bytes %6.1f%%\n",
+			line.name, line.bytes, share);
+		out += buffer;
+	}
+	std::snprintf(buffer, sizeof(buffer),
+		"%lld vertices %lld edges %.1f bytes per edge\n",
+		vertices, edges, bytesPerEdge());
+	out += buffer;
+	return out;
+}
+
+/** return heap bytes malloc uses for a request of size bytes */
+size_t GraphMemoryUsage::heapBlock(size_t size)
+{
+	size_t block = (size + sizeof(size_t) + 15) & ~static_cast<size_t>(15);
+	return block < 32 ? 32 : block;
+}
+
+/** return heap bytes behind a string, 0 if it fits inside it */
+size_t GraphMemoryUsage::stringHeapBytes(const std::string& text)
+{
+	const char* data = text.data();
+	const char* self = reinterpret_cast<const char*>(&text);
+	if (data >= self && data < self + sizeof(std::string))
+		return 0; // short string, stored in the object itself
+	return heapBlock(text.capacity() + 1);
+}
@@ -0,0 +1,52 @@
+/**
+* Memory used by a Graph, broken down by what it is used for
+* Sizes are estimates: container node layouts follow libstdc++ and
+* every heap block is rounded up the way glibc malloc does
+* (8 byte header, 16 byte steps, 32 byte minimum)
+*/
+
+#ifndef GRAPHMEMORY_H
+#define GRAPHMEMORY_H
+
+#include <cstddef>
+#include <string>
+
+class GraphMemoryUsage {
+public:
+	/** number of vertices and edges measured */
+	long long vertices{ 0 };
+	long long edges{ 0 };
+
+	/** slots of the label to vertex hash table */
+	size_t vertexMapBytes{ 0 };
+
+	/** Vertex objects and the index to vertex table */
+	size_t vertexObjectBytes{ 0 };
+
+	/** heap text of every vertex label too long for the string's own
+	buffer, edges and the label index only point at these */
+	size_t labelBytes{ 0 };
+
+	/** adjacency list overhead, unused capacity and malloc rounding */
+	size_t adjacencyNodeBytes{ 0 };
+
+	/** Edge objects */
+	size_t edgePayloadBytes{ 0 };
+
+	/** return the sum of all parts */
+	size_t totalBytes() const;
+
+	/** return totalBytes divided by edges, 0 for no edges */
+	double bytesPerEdge() const;
+
+	/** return a readable table of the parts, one per line */
+	std::string report() const;
+
+	/** return heap bytes malloc uses for a request of size bytes */
+	static size_t heapBlock(size_t size);
+
+	/** return heap bytes behind a string, 0 if it fits inside it */
+	static size_t stringHeapBytes(const std::string& text);
+};  // end GraphMemoryUsage
+
+#endif  // GRAPHMEMORY_H
@@ -0,0 +1,86 @@
+// File Name: labelindex.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "labelindex.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** constructor, empty table */
+LabelIndex::LabelIndex() : slots(16, Slot{ 0, nullptr }) {}
+
+/** return the vertex with label, nullptr if there is none */
+Vertex* LabelIndex::find(const std::string& label) const
+{ return slots[probe(label, hashLabel(label))].vertex; }
+
+/** return the vertex with label
+throws std::out_of_range if there is none, like std::map::at */
+Vertex* LabelIndex::at(const std::string& label) const
+{
+	Vertex* vertex = find(label);
+	if (vertex == nullptr)
+		throw std::out_of_range("no vertex " + label);
+	return vertex;
+}
+
+/** add a vertex, its label must not be in the table yet */
+void LabelIndex::insert(Vertex* vertex)
+{
+	if (2 * (count + 1) > slots.size())
+		grow();
+	size_t hash = hashLabel(vertex->getLabel());
+	Slot& slot = slots[probe(vertex->getLabel(), hash)];
+	slot.hash = hash;
+	slot.vertex = vertex;
+	count++;
+}
+
+/** return number of vertices in the table */
+size_t LabelIndex::size() const { return count; }
+
+/** return bytes used by the slots */
+size_t LabelIndex::memoryBytes() const
+{ return slots.capacity() * sizeof(Slot); }
+
+/** return the hash of a label */
+size_t LabelIndex::hashLabel(const std::string& label)
+{ return std::hash<std::string>()(label); }
+
+/** return the slot holding label, or the empty slot where it
+would go */
+size_t LabelIndex::probe(const std::string& label, size_t hash) const
+{
+	size_t mask = slots.size() - 1;
+	size_t i = hash & mask;
+	while (slots[i].vertex != nullptr &&
+		(slots[i].hash != hash || slots[i].vertex->getLabel() != label))
+		i = (i + 1) & mask;
+	return i;
+}
+
+/** double the number of slots and move every vertex over
+the stored hashes give each vertex's new place directly */
+void LabelIndex::grow()
+{
+	std::vector<Slot> old(2 * slots.size(), Slot{ 0, nullptr });
+	old.swap(slots);
+	size_t mask = slots.size() - 1;
+	for (size_t k = 0; k < old.size(); k++)
+	{
+		if (old[k].vertex == nullptr)
+			continue;
+		size_t i = old[k].hash & mask;
+		while (slots[i].vertex != nullptr)
+			i = (i + 1) & mask;
+		slots[i] = old[k];
+	}
+}
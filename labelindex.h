@@ -0,0 +1,63 @@
+/**
+* Label to vertex lookup for Graph
+* Open addressing hash table with linear probing
+* Each slot keeps the label's hash next to the vertex pointer, so a
+* probe only compares strings when the hashes match and growing the
+* table never hashes a label again
+* The labels themselves are the vertices' own, nothing is copied
+* Vertices can be added but never removed, as in Graph
+*/
+
+#ifndef LABELINDEX_H
+#define LABELINDEX_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "vertex.h"
+
+class LabelIndex {
+public:
+	/** constructor, empty table */
+	LabelIndex();
+
+	/** return the vertex with label, nullptr if there is none */
+	Vertex* find(const std::string& label) const;
+
+	/** return the vertex with label
+	throws std::out_of_range if there is none, like std::map::at */
+	Vertex* at(const std::string& label) const;
+
+	/** add a vertex, its label must not be in the table yet */
+	void insert(Vertex* vertex);
+
+	/** return number of vertices in the table */
+	size_t size() const;
+
+	/** return bytes used by the slots */
+	size_t memoryBytes() const;
+
+private:
+	/** hash and vertex, vertex is nullptr for an empty slot */
+	struct Slot {
+		size_t hash;
+		Vertex* vertex;
+	};
+
+	/** return the hash of a label */
+	static size_t hashLabel(const std::string& label);
+
+	/** return the slot holding label, or the empty slot where it
+	would go */
+	size_t probe(const std::string& label, size_t hash) const;
+
+	/** double the number of slots and move every vertex over */
+	void grow();
+
+	/** power of two number of slots, kept at most half full */
+	std::vector<Slot> slots;
+	size_t count{ 0 };
+};  // end LabelIndex
+
+#endif  // LABELINDEX_H
@@ -0,0 +1,137 @@
+// File Name: mappedfile.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mappedfile.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef _WIN32
+
+/** map filename read-only, see isOpen */
+MappedFile::MappedFile(const std::string& filename)
+{
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ,
+		FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+			0, 0, nullptr);
+		if (mappingHandle != nullptr)
+		{
+			mapping = static_cast<char*>(
+				MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+			if (mapping != nullptr)
+				length = static_cast<size_t>(fileSize.QuadPart);
+		}
+	}
+	CloseHandle(file); // the mapping keeps the file open
+}
+
+/** destructor, unmaps the file */
+MappedFile::~MappedFile()
+{
+	if (mapping != nullptr)
+		UnmapViewOfFile(mapping);
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+}
+
+/** hint how the range start to start + bytes will be read
+start must point into the mapping, the range is widened to pages */
+void MappedFile::advise(Advice advice, const void* start, size_t bytes) const
+{
+	if (mapping == nullptr || bytes == 0 || advice != Advice::WillNeed)
+		return;
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<void*>(start);
+	range.NumberOfBytes = bytes;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+/** map filename read-only, see isOpen */
+MappedFile::MappedFile(const std::string& filename)
+{
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1)
+		return;
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		void* address = mmap(nullptr, static_cast<size_t>(info.st_size),
+			PROT_READ, MAP_SHARED, fd, 0);
+		if (address != MAP_FAILED)
+		{
+			mapping = static_cast<char*>(address);
+			length = static_cast<size_t>(info.st_size);
+		}
+	}
+	close(fd); // the mapping keeps the file open
+}
+
+/** destructor, unmaps the file */
+MappedFile::~MappedFile()
+{
+	if (mapping != nullptr)
+		munmap(mapping, length);
+}
+
+/** hint how the range start to start + bytes will be read
+start must point into the mapping, the range is widened to pages */
+void MappedFile::advise(Advice advice, const void* start, size_t bytes) const
+{
+	if (mapping == nullptr || bytes == 0)
+		return;
+	static const uintptr_t page =
+		static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	uintptr_t from = reinterpret_cast<uintptr_t>(start);
+	uintptr_t to = from + bytes;
+	from -= from % page;
+	int flag = MADV_NORMAL;
+	switch (advice)
+	{
+	case Advice::Normal: flag = MADV_NORMAL; break;
+	case Advice::Sequential: flag = MADV_SEQUENTIAL; break;
+	case Advice::Random: flag = MADV_RANDOM; break;
+	case Advice::WillNeed: flag = MADV_WILLNEED; break;
+	case Advice::DontNeed: flag = MADV_DONTNEED; break;
+	}
+	madvise(reinterpret_cast<void*>(from), to - from, flag);
+}
+
+#endif
+
+/** return true if the file could be opened and mapped */
+bool MappedFile::isOpen() const { return mapping != nullptr; }
+
+/** return the start of the mapping, nullptr if not open */
+const char* MappedFile::data() const { return mapping; }
+
+/** return the size of the file in bytes */
+size_t MappedFile::size() const { return length; }
+
+/** hint how the whole file will be read */
+void MappedFile::advise(Advice advice) const
+{ advise(advice, mapping, length); }
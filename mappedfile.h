@@ -0,0 +1,70 @@
+/**
+* Read-only memory mapping of a whole file
+* Pages are read from disk the first time they are touched and can be
+* dropped again by the operating system, so the file may be larger
+* than memory
+* advise passes access hints to the kernel, madvise on POSIX systems,
+* on Windows only WillNeed does anything (PrefetchVirtualMemory)
+*/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+	/** how a range of the file is about to be read */
+	enum class Advice {
+		/** no hint, the kernel's default readahead */
+		Normal,
+		/** in order, read ahead aggressively and drop pages behind */
+		Sequential,
+		/** scattered, read only the pages touched */
+		Random,
+		/** soon, start reading it in now */
+		WillNeed,
+		/** not again soon, the pages may be dropped */
+		DontNeed
+	};
+
+	/** map filename read-only, see isOpen */
+	explicit MappedFile(const std::string& filename);
+
+	/** destructor, unmaps the file */
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/** return true if the file could be opened and mapped */
+	bool isOpen() const;
+
+	/** return the start of the mapping, nullptr if not open */
+	const char* data() const;
+
+	/** return the size of the file in bytes */
+	size_t size() const;
+
+	/** hint how the range start to start + bytes will be read
+	start must point into the mapping, the range is widened to pages */
+	void advise(Advice advice, const void* start, size_t bytes) const;
+
+	/** hint how the whole file will be read */
+	void advise(Advice advice) const;
+
+private:
+	/** start of the mapping, nullptr if not open */
+	char* mapping{ nullptr };
+
+	/** size of the file and the mapping */
+	size_t length{ 0 };
+
+#ifdef _WIN32
+	/** file mapping object, unmapped and closed by the destructor */
+	void* mappingHandle{ nullptr };
+#endif
+};  // end MappedFile
+
+#endif  // MAPPEDFILE_H
@@ -0,0 +1,653 @@
+// File Name: partitionedgraph.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "graph.h"
+#include "partitionedgraph.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** one update for a vertex owned by another worker
+breadth-first: value is the sender's rank, edge its edge position
+shortest paths: value is the new cost */
+struct BspMessage {
+	int target;
+	int value;
+	int parent;
+	int edge;
+};
+
+/** order of a vertex found by breadth-first search within its level,
+rank of the vertex that found it and position of the edge */
+struct BspKey {
+	int rank;
+	int edge;
+	bool operator<(const BspKey& other) const
+	{ return rank < other.rank || (rank == other.rank && edge < other.edge); }
+};
+
+/** start of the shared block, only touched through atomics */
+struct BspHeader {
+	std::atomic<int> arrived;
+	std::atomic<int> generation;
+	std::atomic<int> aborted;
+	std::atomic<int> supersteps;
+	/** set when shortest paths still improve after numVertices steps */
+	std::atomic<int> negativeCycle;
+	std::atomic<long long> active[2];
+	std::atomic<long long> messages;
+};
+
+/** thrown inside a worker when another worker failed */
+struct BspAborted {};
+
+/** everything one worker needs, pointers into the graph's arrays and
+into the shared block */
+struct BspWorker {
+	int me;
+	int workers;
+	int numVertices;
+	const long long* offsets;
+	const int* targets;
+	const int* weights;
+	const int* owner;
+
+	BspHeader* header;
+	/** mailbox from worker i to worker j holds mailboxCount[i * p + j]
+	messages starting at mailbox[mailboxStart[i * p + j]] */
+	long long* mailboxCount;
+	BspMessage* mailbox;
+	const long long* mailboxStart;
+	/** keys of each worker's newest breadth-first level, sorted */
+	long long* keyCount;
+	BspKey* keys;
+	const long long* keyStart;
+	/** per vertex results, written by the owner at the end */
+	int* result;
+	int* previous;
+
+	/** messages this worker sent */
+	long long sent{ 0 };
+
+	/** wait for all workers, sense is the barrier generation */
+	void barrier()
+	{
+		int generation = header->generation.load();
+		if (header->arrived.fetch_add(1) + 1 == workers)
+		{
+			header->arrived.store(0);
+			header->generation.fetch_add(1);
+		}
+		else
+			while (header->generation.load() == generation)
+			{
+				if (header->aborted.load() != 0)
+					throw BspAborted();
+				std::this_thread::yield();
+			}
+	}
+
+	/** put a message in the mailbox to worker to */
+	void send(int to, const BspMessage& message)
+	{
+		long long box = static_cast<long long>(me) * workers + to;
+		mailbox[mailboxStart[box] + mailboxCount[box]++] = message;
+		sent++;
+	}
+
+	/** call f on every message sent to this worker, then empty them */
+	template <typename F>
+	void receive(F f)
+	{
+		for (int from = 0; from < workers; from++)
+		{
+			long long box = static_cast<long long>(from) * workers + me;
+			const BspMessage* first = mailbox + mailboxStart[box];
+			for (long long i = 0; i < mailboxCount[box]; i++)
+				f(first[i]);
+			mailboxCount[box] = 0;
+		}
+	}
+
+	/** count vertices found in a superstep, return the total over all
+	workers once everybody has counted */
+	long long countActive(int step, long long found)
+	{
+		header->active[step % 2].fetch_add(found);
+		if (me == 0)
+			header->active[(step + 1) % 2].store(0);
+		barrier();
+		if (me == 0)
+			header->supersteps.fetch_add(1);
+		return header->active[step % 2].load();
+	}
+
+	/** breadth-first search, result is the rank in Graph's order */
+	void breadthFirst(int start)
+	{
+		std::vector<int> level(numVertices, -1);
+		std::vector<int> rankOf(numVertices, -1);
+		std::vector<int> parent(numVertices, -1);
+		std::vector<BspKey> key(numVertices);
+		std::vector<int> frontier;
+		std::vector<int> found;
+		if (owner[start] == me)
+		{
+			level[start] = 0;
+			rankOf[start] = 0;
+			frontier.push_back(start);
+		}
+
+		int depth = 0;
+		auto consider = [&](int u, BspKey k, int from) {
+			if (level[u] == -1)
+			{
+				level[u] = depth + 1;
+				key[u] = k;
+				parent[u] = from;
+				found.push_back(u);
+			}
+			else if (level[u] == depth + 1 && k < key[u])
+			{
+				key[u] = k;
+				parent[u] = from;
+			}
+		};
+
+		long long levelStart = 1; // rank of the level's first vertex
+		for (int step = 0;; step++)
+		{
+			for (int v : frontier)
+				for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+				{
+					int u = targets[e];
+					BspKey k{ rankOf[v], static_cast<int>(e - offsets[v]) };
+					if (owner[u] == me)
+						consider(u, k, v);
+					else
+						send(owner[u], BspMessage{ u, k.rank, v, k.edge });
+				}
+			barrier();
+
+			receive([&](const BspMessage& m) {
+				consider(m.target, BspKey{ m.value, m.edge }, m.parent);
+			});
+			std::sort(found.begin(), found.end(),
+				[&key](int a, int b) { return key[a] < key[b]; });
+			for (size_t i = 0; i < found.size(); i++)
+				keys[keyStart[me] + i] = key[found[i]];
+			keyCount[me] = static_cast<long long>(found.size());
+			long long total = countActive(step,
+				static_cast<long long>(found.size()));
+			if (total == 0)
+				break;
+
+			// rank = vertices in this level with a smaller key, anywhere
+			std::vector<long long> below(workers, 0);
+			for (size_t i = 0; i < found.size(); i++)
+			{
+				long long rank = levelStart + static_cast<long long>(i);
+				for (int w = 0; w < workers; w++)
+				{
+					if (w == me)
+						continue;
+					const BspKey* theirs = keys + keyStart[w];
+					while (below[w] < keyCount[w] &&
+						theirs[below[w]] < key[found[i]])
+						below[w]++;
+					rank += below[w];
+				}
+				rankOf[found[i]] = static_cast<int>(rank);
+			}
+			levelStart += total;
+			frontier.swap(found);
+			found.clear();
+			depth++;
+		}
+
+		for (int v = 0; v < numVertices; v++)
+			if (owner[v] == me)
+			{
+				result[v] = rankOf[v];
+				previous[v] = parent[v];
+			}
+	}
+
+	/** shortest paths in supersteps, a vertex whose cost went down
+	relaxes its edges in the next one, until no cost goes down
+	on a tie the lower previous index wins, so the result does not
+	depend on the order messages arrive in
+	step s finds paths of s + 1 edges, a cost still going down after
+	numVertices steps is on a negative cycle, every worker sees the
+	same total and stops in the same step */
+	void shortestPaths(int start)
+	{
+		std::vector<int> cost(numVertices, INT_MAX);
+		std::vector<int> prev(numVertices, -1);
+		std::vector<char> queued(numVertices, 0);
+		std::vector<int> active;
+		std::vector<int> next;
+		if (owner[start] == me)
+		{
+			cost[start] = 0;
+			active.push_back(start);
+		}
+
+		auto relax = [&](int u, int newCost, int from) {
+			if (newCost < cost[u])
+			{
+				cost[u] = newCost;
+				prev[u] = from;
+				if (!queued[u])
+				{
+					queued[u] = 1;
+					next.push_back(u);
+				}
+			}
+			else if (newCost == cost[u] && from < prev[u])
+				prev[u] = from;
+		};
+
+		for (int step = 0;; step++)
+		{
+			for (int v : active)
+			{
+				queued[v] = 0;
+				for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+				{
+					int u = targets[e];
+					int newCost = cost[v] + weights[e];
+					if (owner[u] == me)
+						relax(u, newCost, v);
+					else
+						send(owner[u], BspMessage{ u, newCost, v, 0 });
+				}
+			}
+			barrier();
+
+			receive([&](const BspMessage& m) {
+				relax(m.target, m.value, m.parent);
+			});
+			long long total = countActive(step,
+				static_cast<long long>(next.size()));
+			if (total == 0)
+				break;
+			if (step >= numVertices)
+			{
+				header->negativeCycle.store(1);
+				break;
+			}
+			active.swap(next);
+			next.clear();
+		}
+
+		for (int v = 0; v < numVertices; v++)
+			if (owner[v] == me)
+			{
+				result[v] = cost[v];
+				previous[v] = prev[v];
+			}
+	}
+};  // end BspWorker
+
+/** mix a vertex index into a well spread number, splitmix64 */
+static uint64_t mixIndex(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/** constructor, divide graph's vertices between workers */
+PartitionedGraph::PartitionedGraph(const Graph& graph, int workers,
+	Partitioning partitioning) : graph(&graph), numWorkers(workers)
+{
+	if (numWorkers < 1)
+		numWorkers = 1;
+	int n = graph.getNumVertices();
+	offsets.assign(1, 0);
+	targets.reserve(graph.getNumEdges());
+	weights.reserve(graph.getNumEdges());
+	for (int v = 0; v < n; v++)
+	{
+		for (const Edge& edge : graph.vertexList[v]->getAdjacencyList())
+		{
+			targets.push_back(edge.getEndVertex());
+			weights.push_back(edge.getWeight());
+		}
+		offsets.push_back(static_cast<long long>(targets.size()));
+	}
+
+	owner.assign(n, 0);
+	if (partitioning == Partitioning::EdgeCut)
+		partitionByEdgeCut();
+	else
+		for (int v = 0; v < n; v++)
+			owner[v] = static_cast<int>(mixIndex(v) % numWorkers);
+
+	partitionSize.assign(numWorkers, 0);
+	cutEdgesBetween.assign(
+		static_cast<size_t>(numWorkers) * numWorkers, 0);
+	for (int v = 0; v < n; v++)
+	{
+		partitionSize[owner[v]]++;
+		for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+			if (owner[targets[e]] != owner[v])
+				cutEdgesBetween[owner[v] * numWorkers + owner[targets[e]]]++;
+	}
+}
+
+/** return number of workers */
+int PartitionedGraph::getNumWorkers() const { return numWorkers; }
+
+/** return the worker owning a vertex index */
+int PartitionedGraph::getOwner(int vertexIndex) const
+{ return owner.at(vertexIndex); }
+
+/** return number of vertices a worker owns */
+int PartitionedGraph::getPartitionSize(int worker) const
+{ return partitionSize.at(worker); }
+
+/** return number of edges between vertices of different workers */
+long long PartitionedGraph::getCutEdges() const
+{
+	long long cut = 0;
+	for (long long edges : cutEdgesBetween)
+		cut += edges;
+	return cut;
+}
+
+/** breadth-first traversal, visit is called in the same order as
+Graph::breadthFirstTraversal once all workers are done
+throws std::runtime_error if a worker could not run */
+void PartitionedGraph::breadthFirstTraversal(const std::string& startLabel,
+	void visit(const std::string&))
+{
+	std::vector<int> order = breadthFirstOrder(startLabel);
+	for (int v : order)
+		visit(graph->getVertexLabel(v));
+}
+
+/** vertex indices in breadth-first order from startLabel */
+std::vector<int> PartitionedGraph::breadthFirstOrder(
+	const std::string& startLabel)
+{
+	std::vector<int> rank;
+	std::vector<int> previous;
+	run(Algorithm::BreadthFirst, startIndex(startLabel), rank, previous);
+	std::vector<int> order;
+	for (int v = 0; v < static_cast<int>(rank.size()); v++)
+		if (rank[v] >= 0)
+		{
+			if (static_cast<size_t>(rank[v]) >= order.size())
+				order.resize(rank[v] + 1, -1);
+			order[rank[v]] = v;
+		}
+	return order;
+}
+
+/** shortest path costs from startLabel, same maps as
+Graph::djikstraCostToAllVertices, the start is not included
+throws std::runtime_error if a worker could not run,
+std::domain_error if a negative cycle can be reached */
+void PartitionedGraph::djikstraCostToAllVertices(
+	const std::string& startLabel, std::map<std::string, int>& weight,
+	std::map<std::string, std::string>& previous)
+{
+	weight.clear();
+	previous.clear();
+	std::vector<int> cost;
+	std::vector<int> prev;
+	int start = startIndex(startLabel);
+	run(Algorithm::ShortestPaths, start, cost, prev);
+	for (int v = 0; v < static_cast<int>(cost.size()); v++)
+		if (v != start && cost[v] != INT_MAX)
+		{
+			weight[graph->getVertexLabel(v)] = cost[v];
+			previous[graph->getVertexLabel(v)] =
+				graph->getVertexLabel(prev[v]);
+		}
+}
+
+/** return the index of startLabel
+throws std::out_of_range if it is not in the graph, like Graph */
+int PartitionedGraph::startIndex(const std::string& startLabel) const
+{
+	int start = graph->getVertexIndex(startLabel);
+	if (start == -1)
+		throw std::out_of_range("no vertex " + startLabel);
+	return start;
+}
+
+/** return what the last run sent */
+const PartitionedGraph::CommunicationStats&
+PartitionedGraph::getLastStats() const { return lastStats; }
+
+/** run all workers from start, fill result and lastStats
+the shared block is laid out as header, mailbox counts, mailboxes
+sized by cutEdgesBetween, key counts, keys, results
+a mailbox never overflows: a vertex sends once per edge a superstep */
+void PartitionedGraph::run(Algorithm algorithm, int start,
+	std::vector<int>& result, std::vector<int>& previous)
+{
+	int n = static_cast<int>(owner.size());
+	long long p = numWorkers;
+	std::vector<long long> mailboxStart(p * p, 0);
+	long long mailboxTotal = 0;
+	for (long long box = 0; box < p * p; box++)
+	{
+		mailboxStart[box] = mailboxTotal;
+		mailboxTotal += cutEdgesBetween[box];
+	}
+	std::vector<long long> keyStart(p, 0);
+	for (int w = 1; w < p; w++)
+		keyStart[w] = keyStart[w - 1] + partitionSize[w - 1];
+
+	auto align = [](size_t bytes) { return (bytes + 63) / 64 * 64; };
+	size_t countsAt = align(sizeof(BspHeader));
+	size_t mailboxAt = align(countsAt + sizeof(long long) * p * p);
+	size_t keyCountAt = align(mailboxAt + sizeof(BspMessage) * mailboxTotal);
+	size_t keysAt = align(keyCountAt + sizeof(long long) * p);
+	size_t resultAt = align(keysAt + sizeof(BspKey) * n);
+	size_t previousAt = align(resultAt + sizeof(int) * n);
+	size_t size = align(previousAt + sizeof(int) * n);
+
+#ifdef _WIN32
+	std::vector<char> memory(size + 64, 0);
+	char* block = reinterpret_cast<char*>(
+		(reinterpret_cast<uintptr_t>(memory.data()) + 63) / 64 * 64);
+#else
+	void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (mapped == MAP_FAILED)
+		throw std::runtime_error("no shared memory for workers");
+	char* block = static_cast<char*>(mapped); // zero filled
+#endif
+	BspHeader* header = new (block) BspHeader();
+
+	auto work = [&](int me) {
+		BspWorker worker{ me, numWorkers, n, offsets.data(), targets.data(),
+			weights.data(), owner.data(), header,
+			reinterpret_cast<long long*>(block + countsAt),
+			reinterpret_cast<BspMessage*>(block + mailboxAt),
+			mailboxStart.data(),
+			reinterpret_cast<long long*>(block + keyCountAt),
+			reinterpret_cast<BspKey*>(block + keysAt), keyStart.data(),
+			reinterpret_cast<int*>(block + resultAt),
+			reinterpret_cast<int*>(block + previousAt) };
+		if (algorithm == Algorithm::BreadthFirst)
+			worker.breadthFirst(start);
+		else
+			worker.shortestPaths(start);
+		header->messages.fetch_add(worker.sent);
+	};
+
+	bool ok = true;
+#ifdef _WIN32
+	std::vector<std::thread> threads;
+	for (int me = 0; me < numWorkers; me++)
+		threads.push_back(std::thread([&work, &header, &ok, me]() {
+			try { work(me); }
+			catch (...) { header->aborted.store(1); }
+		}));
+	for (std::thread& t : threads)
+		t.join();
+	ok = header->aborted.load() == 0;
+#else
+	// each worker is a copy of this process, it only writes to the block
+	// only the workers are waited for, the host may have other children
+	std::vector<pid_t> started;
+	for (int me = 0; me < numWorkers; me++)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			int status = 0;
+			try { work(me); }
+			catch (...) { header->aborted.store(1); status = 1; }
+			_exit(status);
+		}
+		if (pid < 0)
+		{
+			header->aborted.store(1); // the others stop at the barrier
+			ok = false;
+			break;
+		}
+		started.push_back(pid);
+	}
+	for (pid_t pid : started)
+	{
+		int status = 0;
+		if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+			WEXITSTATUS(status) != 0)
+		{
+			header->aborted.store(1);
+			ok = false;
+		}
+	}
+#endif
+
+	bool negativeCycle = header->negativeCycle.load() != 0;
+	if (ok && !negativeCycle)
+	{
+		const int* results = reinterpret_cast<const int*>(block + resultAt);
+		const int* previousIn =
+			reinterpret_cast<const int*>(block + previousAt);
+		result.assign(results, results + n);
+		previous.assign(previousIn, previousIn + n);
+		lastStats.supersteps = header->supersteps.load();
+		lastStats.messages = header->messages.load();
+		lastStats.messageBytes = lastStats.messages *
+			static_cast<long long>(sizeof(BspMessage));
+	}
+	header->~BspHeader();
+#ifndef _WIN32
+	munmap(mapped, size);
+#endif
+	if (!ok)
+		throw std::runtime_error("a worker process failed");
+	if (negativeCycle)
+		throw std::domain_error("negative cycle reachable from " +
+			graph->getVertexLabel(start));
+}
+
+/** assign owners with the linear deterministic greedy heuristic
+vertices are placed in breadth-first order ignoring edge direction,
+so most have placed neighbors when their turn comes
+score of worker w: placed neighbors on w * (1 - size of w / capacity) */
+void PartitionedGraph::partitionByEdgeCut()
+{
+	int n = static_cast<int>(owner.size());
+	long long capacity = (n + numWorkers - 1) / numWorkers;
+
+	// incoming edges, to count neighbors both ways
+	std::vector<long long> inOffsets(n + 1, 0);
+	for (int target : targets)
+		inOffsets[target + 1]++;
+	for (int v = 0; v < n; v++)
+		inOffsets[v + 1] += inOffsets[v];
+	std::vector<int> sources(targets.size());
+	std::vector<long long> fill(inOffsets.begin(), inOffsets.end() - 1);
+	for (int v = 0; v < n; v++)
+		for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+			sources[fill[targets[e]]++] = v;
+
+	std::vector<int> order;
+	std::vector<char> seen(n, 0);
+	order.reserve(n);
+	for (int root = 0; root < n; root++)
+	{
+		if (seen[root])
+			continue;
+		seen[root] = 1;
+		order.push_back(root);
+		for (size_t head = order.size() - 1; head < order.size(); head++)
+		{
+			int v = order[head];
+			auto reach = [&](int u) {
+				if (!seen[u])
+				{
+					seen[u] = 1;
+					order.push_back(u);
+				}
+			};
+			for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+				reach(targets[e]);
+			for (long long e = inOffsets[v]; e < inOffsets[v + 1]; e++)
+				reach(sources[e]);
+		}
+	}
+
+	std::vector<long long> size(numWorkers, 0);
+	std::vector<long long> placed(numWorkers, 0);
+	std::fill(owner.begin(), owner.end(), -1);
+	for (int v : order)
+	{
+		std::fill(placed.begin(), placed.end(), 0);
+		for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+			if (owner[targets[e]] >= 0)
+				placed[owner[targets[e]]]++;
+		for (long long e = inOffsets[v]; e < inOffsets[v + 1]; e++)
+			if (owner[sources[e]] >= 0)
+				placed[owner[sources[e]]]++;
+
+		int best = -1;
+		double bestScore = 0;
+		for (int w = 0; w < numWorkers; w++)
+		{
+			if (size[w] >= capacity)
+				continue;
+			double score = placed[w] * (1.0 - double(size[w]) / capacity);
+			if (best == -1 || score > bestScore ||
+				(score == bestScore && size[w] < size[best]))
+			{
+				best = w;
+				bestScore = score;
+			}
+		}
+		owner[v] = best;
+		size[best]++;
+	}
+}
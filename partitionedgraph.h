@@ -0,0 +1,129 @@
+/**
+* Breadth-first traversal and shortest paths run by several worker
+* processes, each owning part of a Graph's vertices, as a model of
+* running on several machines
+*
+* Workers run in bulk synchronous supersteps: each works on the
+* vertices it owns, sends updates for vertices owned by others to
+* their mailboxes, then all wait at a barrier before reading what
+* they were sent. Mailboxes, the barrier and the results live in one
+* shared memory block, on Windows the workers are threads instead
+*
+* Results are the same as the single process Graph versions:
+*   breadthFirstTraversal visits in exactly Graph's order, each new
+*   level is ordered by the rank of the vertex that found a vertex
+*   first and the position of the edge in its adjacency list
+*   djikstraCostToAllVertices gives the same costs, where several
+*   shortest paths tie the previous vertex is the one with the lowest
+*   index, which Graph's Djikstra need not choose
+*
+* Partitioning:
+*   Hash     vertex index hashed, even sizes, ignores the edges
+*   EdgeCut  greedy streaming partitioner (linear deterministic greedy)
+*            in breadth-first order, places each vertex with most of
+*            its already placed neighbors while keeping sizes even
+* CommunicationStats counts the messages the last run sent
+* The graph must outlive the PartitionedGraph and not change
+*/
+
+#ifndef PARTITIONEDGRAPH_H
+#define PARTITIONEDGRAPH_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+class Graph;
+
+class PartitionedGraph {
+public:
+	/** how vertices are divided between workers */
+	enum class Partitioning { Hash, EdgeCut };
+
+	/** what the workers of the last run sent each other */
+	struct CommunicationStats {
+		/** supersteps, each ending with a barrier */
+		int supersteps{ 0 };
+		/** updates sent to another worker */
+		long long messages{ 0 };
+		/** bytes of those updates */
+		long long messageBytes{ 0 };
+	};
+
+	/** constructor, divide graph's vertices between workers */
+	PartitionedGraph(const Graph& graph, int workers,
+		Partitioning partitioning);
+
+	/** return number of workers */
+	int getNumWorkers() const;
+
+	/** return the worker owning a vertex index */
+	int getOwner(int vertexIndex) const;
+
+	/** return number of vertices a worker owns */
+	int getPartitionSize(int worker) const;
+
+	/** return number of edges between vertices of different workers */
+	long long getCutEdges() const;
+
+	/** breadth-first traversal, visit is called in the same order as
+	Graph::breadthFirstTraversal once all workers are done
+	throws std::runtime_error if a worker could not run */
+	void breadthFirstTraversal(const std::string& startLabel,
+		void visit(const std::string&));
+
+	/** vertex indices in breadth-first order from startLabel */
+	std::vector<int> breadthFirstOrder(const std::string& startLabel);
+
+	/** shortest path costs from startLabel, same maps as
+	Graph::djikstraCostToAllVertices, the start is not included
+	negative weights are fine, the supersteps are Bellman-Ford rounds
+	throws std::runtime_error if a worker could not run,
+	std::domain_error if a negative cycle can be reached */
+	void djikstraCostToAllVertices(const std::string& startLabel,
+		std::map<std::string, int>& weight,
+		std::map<std::string, std::string>& previous);
+
+	/** return what the last run sent */
+	const CommunicationStats& getLastStats() const;
+
+private:
+	/** which algorithm run executes */
+	enum class Algorithm { BreadthFirst, ShortestPaths };
+
+	/** run all workers from start, fill result and lastStats
+	result has one entry per vertex: breadth-first rank or cost,
+	and previous vertex */
+	void run(Algorithm algorithm, int start, std::vector<int>& result,
+		std::vector<int>& previous);
+
+	/** return the index of startLabel
+	throws std::out_of_range if it is not in the graph, like Graph */
+	int startIndex(const std::string& startLabel) const;
+
+	/** assign owners with the linear deterministic greedy heuristic */
+	void partitionByEdgeCut();
+
+	/** graph the partition came from, used to translate labels */
+	const Graph* graph;
+
+	int numWorkers;
+
+	/** edges of v are targets[offsets[v] .. offsets[v + 1]),
+	in the graph's alphabetical order, with their weights */
+	std::vector<long long> offsets;
+	std::vector<int> targets;
+	std::vector<int> weights;
+
+	/** worker of each vertex and vertices of each worker */
+	std::vector<int> owner;
+	std::vector<int> partitionSize;
+
+	/** edges from vertices of worker i to vertices of worker j,
+	cutEdgesBetween[i * numWorkers + j], the size of that mailbox */
+	std::vector<long long> cutEdgesBetween;
+
+	CommunicationStats lastStats;
+};  // end PartitionedGraph
+
+#endif  // PARTITIONEDGRAPH_H
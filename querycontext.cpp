@@ -0,0 +1,119 @@
+// File Name: querycontext.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <algorithm>
+#include <vector>
+
+#include "querycontext.h"
+#include "relaxkernel.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** constructor, empty buffers */
+QueryContext::QueryContext() {}
+
+/** start a new query over a graph with numVertices vertices
+clears all marks in O(1) and grows buffers only when needed */
+void QueryContext::beginQuery(int numVertices)
+{
+	size_t size = static_cast<size_t>(numVertices);
+	if (visitedMark.size() < size)
+	{
+		visitedMark.resize(size, 0);
+		settledMark.resize(size, 0);
+		reachedMark.resize(size, 0);
+		distance.resize(size, 0);
+		previous.resize(size, -1);
+	}
+	epoch++;
+	if (epoch == 0) // wrapped around, old marks could look current
+	{
+		std::fill(visitedMark.begin(), visitedMark.end(), 0);
+		std::fill(settledMark.begin(), settledMark.end(), 0);
+		std::fill(reachedMark.begin(), reachedMark.end(), 0);
+		epoch = 1;
+	}
+	reached.clear();
+	stack.clear();
+	frontier.clear();
+	heap.clear();
+#ifdef GRAPH_COUNTERS
+	counters.reset();
+	counters.queries = 1;
+#endif
+}
+
+/** return true if vertex has been visited in this query */
+bool QueryContext::isVisited(int index) const
+{ return visitedMark[index] == epoch; }
+
+/** mark vertex as visited in this query */
+void QueryContext::visit(int index) { visitedMark[index] = epoch; }
+
+/** return true if vertex has been settled by Djikstra in this query */
+bool QueryContext::isSettled(int index) const
+{ return settledMark[index] == epoch; }
+
+/** mark vertex as settled in this query */
+void QueryContext::settle(int index) { settledMark[index] = epoch; }
+
+/** return true if vertex has a tentative distance in this query */
+bool QueryContext::isReached(int index) const
+{ return reachedMark[index] == epoch; }
+
+/** return the tentative distance, only valid if isReached */
+int QueryContext::getDistance(int index) const { return distance[index]; }
+
+/** return previous vertex index on the path, -1 for the start */
+int QueryContext::getPrevious(int index) const { return previous[index]; }
+
+/** set distance and previous vertex, records vertex as reached */
+void QueryContext::setDistance(int index, int cost, int prev)
+{
+	if (reachedMark[index] != epoch)
+	{
+		reachedMark[index] = epoch;
+		reached.push_back(index);
+	}
+	distance[index] = cost;
+	previous[index] = prev;
+}
+
+/** vertices reached in this query, in the order they were reached */
+const std::vector<int>& QueryContext::getReached() const { return reached; }
+
+/** find the edges that would lower their end vertex's tentative
+distance when leaving a vertex at cost, see relaxkernel.h
+@return how many, their positions are getImprovedEdges()[0 ..] */
+int QueryContext::findImprovedEdges(const Edge* edges, int count, int cost)
+{
+	if (improved.size() < static_cast<size_t>(count))
+		improved.resize(count);
+	return relaxEdges(edges, count, cost, distance.data(),
+		reachedMark.data(), epoch, improved.data());
+}
+
+/** positions found by the last findImprovedEdges */
+const std::vector<int>& QueryContext::getImprovedEdges() const
+{ return improved; }
+
+/** depth-first stack, empty at the start of each query */
+std::vector<QueryContext::DfsFrame>& QueryContext::getStack()
+{ return stack; }
+
+/** breadth-first frontier, empty at the start of each query */
+std::vector<int>& QueryContext::getFrontier() { return frontier; }
+
+/** Djikstra heap, empty at the start of each query */
+std::vector<QueryContext::HeapEntry>& QueryContext::getHeap() { return heap; }
+
+/** work done by the current or last query, see querycounters.h
+all 0 unless built with GRAPH_COUNTERS */
+QueryCounters& QueryContext::getCounters() { return counters; }
+
+const QueryCounters& QueryContext::getCounters() const { return counters; }
@@ -0,0 +1,119 @@
+/**
+* Per-query traversal state for Graph
+* Holds the visited marks, DFS stack, BFS frontier and Djikstra buffers
+* so that the Graph itself is never modified by a query
+* One QueryContext per thread lets many queries run on one const Graph
+* Buffers grow to the largest graph seen and are reused afterwards,
+* so repeated queries do not allocate
+*/
+
+#ifndef QUERYCONTEXT_H
+#define QUERYCONTEXT_H
+
+#include <utility>
+#include <vector>
+
+#include "querycounters.h"
+#include "vertex.h"
+
+class QueryContext {
+public:
+	/** one frame of the depth-first stack
+	vertex index and the next neighbor to look at */
+	typedef std::pair<int, Vertex::AdjacencyList::const_iterator> DfsFrame;
+
+	/** priority queue entry for Djikstra, cost and vertex index */
+	typedef std::pair<int, int> HeapEntry;
+
+	/** constructor, empty buffers */
+	QueryContext();
+
+	/** start a new query over a graph with numVertices vertices
+	clears all marks in O(1) and grows buffers only when needed */
+	void beginQuery(int numVertices);
+
+	/** return true if vertex has been visited in this query */
+	bool isVisited(int index) const;
+
+	/** mark vertex as visited in this query */
+	void visit(int index);
+
+	/** return true if vertex has been settled by Djikstra in this query */
+	bool isSettled(int index) const;
+
+	/** mark vertex as settled in this query */
+	void settle(int index);
+
+	/** return true if vertex has a tentative distance in this query */
+	bool isReached(int index) const;
+
+	/** return the tentative distance, only valid if isReached */
+	int getDistance(int index) const;
+
+	/** return previous vertex index on the path, -1 for the start */
+	int getPrevious(int index) const;
+
+	/** set distance and previous vertex, records vertex as reached */
+	void setDistance(int index, int distance, int previous);
+
+	/** vertices reached in this query, in the order they were reached */
+	const std::vector<int>& getReached() const;
+
+	/** find the edges that would lower their end vertex's tentative
+	distance when leaving a vertex at cost, see relaxkernel.h
+	@return how many, their positions are getImprovedEdges()[0 ..] */
+	int findImprovedEdges(const Edge* edges, int count, int cost);
+
+	/** positions found by the last findImprovedEdges */
+	const std::vector<int>& getImprovedEdges() const;
+
+	/** depth-first stack, empty at the start of each query */
+	std::vector<DfsFrame>& getStack();
+
+	/** breadth-first frontier, empty at the start of each query */
+	std::vector<int>& getFrontier();
+
+	/** Djikstra heap, empty at the start of each query */
+	std::vector<HeapEntry>& getHeap();
+
+	/** work done by the current or last query, see querycounters.h
+	all 0 unless built with GRAPH_COUNTERS */
+	QueryCounters& getCounters();
+	const QueryCounters& getCounters() const;
+
+private:
+	/** current query number, marks equal to it are set */
+	unsigned int epoch{ 0 };
+
+	/** visitedMark[i] == epoch if vertex i is visited */
+	std::vector<unsigned int> visitedMark;
+
+	/** settledMark[i] == epoch if vertex i is settled */
+	std::vector<unsigned int> settledMark;
+
+	/** reachedMark[i] == epoch if distance[i] is valid */
+	std::vector<unsigned int> reachedMark;
+
+	/** tentative or final distance for each vertex */
+	std::vector<int> distance;
+
+	/** previous vertex index on the shortest path */
+	std::vector<int> previous;
+
+	/** vertices with a valid distance, in order reached */
+	std::vector<int> reached;
+
+	/** edge positions from findImprovedEdges, grows to the largest
+	number of edges of a vertex */
+	std::vector<int> improved;
+
+	/** buffers for the traversals */
+	std::vector<DfsFrame> stack;
+	std::vector<int> frontier;
+	std::vector<HeapEntry> heap;
+
+	/** counts for the current query */
+	QueryCounters counters;
+};  // end QueryContext
+
+#endif  // QUERYCONTEXT_H
@@ -0,0 +1,73 @@
+// File Name: querycounters.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <atomic>
+
+#include "querycounters.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** add the counts of another query, high water marks take the max */
+void QueryCounters::add(const QueryCounters& other)
+{
+	queries += other.queries;
+	verticesSettled += other.verticesSettled;
+	edgesRelaxed += other.edgesRelaxed;
+	heapPushes += other.heapPushes;
+	stalePops += other.stalePops;
+	vertexLookups += other.vertexLookups;
+	neighborResets += other.neighborResets;
+	if (other.frontierHighWater > frontierHighWater)
+		frontierHighWater = other.frontierHighWater;
+}
+
+/** add the counts of one finished query */
+void GraphCounters::record(const QueryCounters& query)
+{
+	verticesSettled += query.verticesSettled;
+	edgesRelaxed += query.edgesRelaxed;
+	heapPushes += query.heapPushes;
+	stalePops += query.stalePops;
+	vertexLookups += query.vertexLookups;
+	neighborResets += query.neighborResets;
+	long long high = frontierHighWater.load();
+	while (query.frontierHighWater > high &&
+		!frontierHighWater.compare_exchange_weak(high,
+			query.frontierHighWater))
+	{
+	}
+	queries += query.queries;
+}
+
+/** return the totals so far */
+QueryCounters GraphCounters::snapshot() const
+{
+	QueryCounters totals;
+	totals.queries = queries.load();
+	totals.verticesSettled = verticesSettled.load();
+	totals.edgesRelaxed = edgesRelaxed.load();
+	totals.heapPushes = heapPushes.load();
+	totals.stalePops = stalePops.load();
+	totals.vertexLookups = vertexLookups.load();
+	totals.neighborResets = neighborResets.load();
+	totals.frontierHighWater = frontierHighWater.load();
+	return totals;
+}
+
+/** set the totals back to 0 */
+void GraphCounters::reset()
+{
+	verticesSettled = 0;
+	edgesRelaxed = 0;
+	heapPushes = 0;
+	stalePops = 0;
+	vertexLookups = 0;
+	neighborResets = 0;
+	frontierHighWater = 0;
+	queries = 0;
+}
@@ -0,0 +1,93 @@
+/**
+* Work counters for traversals and Djikstra
+* Only compiled in when GRAPH_COUNTERS is defined, for example
+* make COUNTERS=1, otherwise every GRAPH_COUNT is empty and all
+* counters stay 0
+* QueryContext::getCounters has the counts of its last query
+* Graph::getCounters has the totals of every finished query on it
+*/
+
+#ifndef QUERYCOUNTERS_H
+#define QUERYCOUNTERS_H
+
+#include <atomic>
+
+#ifdef GRAPH_COUNTERS
+#define GRAPH_COUNT(counters, field, amount) \
+	((counters).field += (amount))
+#define GRAPH_COUNT_MAX(counters, field, value) \
+	((counters).field = (counters).field < (value) ? (value) : \
+		(counters).field)
+#else
+#define GRAPH_COUNT(counters, field, amount) ((void)(counters))
+#define GRAPH_COUNT_MAX(counters, field, value) ((void)(counters))
+#endif
+
+class QueryCounters {
+public:
+#ifdef GRAPH_COUNTERS
+	static constexpr bool enabled = true;
+#else
+	static constexpr bool enabled = false;
+#endif
+
+	/** set every counter to 0 */
+	void reset() { *this = QueryCounters(); }
+
+	/** add the counts of another query, high water marks take the max */
+	void add(const QueryCounters& other);
+
+	/** number of queries counted, 1 for a single query */
+	long long queries{ 0 };
+
+	/** Djikstra: vertices given their final cost */
+	long long verticesSettled{ 0 };
+
+	/** Djikstra and DAG: edges looked at from a settled vertex
+	Bellman-Ford: edges of each round's frontier */
+	long long edgesRelaxed{ 0 };
+
+	/** Djikstra: entries pushed onto the heap */
+	long long heapPushes{ 0 };
+
+	/** Djikstra: entries popped after a cheaper one was used */
+	long long stalePops{ 0 };
+
+	/** DFS and BFS: edge end vertices loaded from vertexList by index,
+	one per edge followed, a plain array load, there is no map lookup
+	Djikstra reads costs by index and counts only edgesRelaxed
+	the LabelIndex probe for the start label is not counted */
+	long long vertexLookups{ 0 };
+
+	/** neighbor cursors started at the first neighbor */
+	long long neighborResets{ 0 };
+
+	/** largest DFS stack, BFS frontier or Bellman-Ford frontier seen */
+	long long frontierHighWater{ 0 };
+};  // end QueryCounters
+
+/** totals over many queries, safe to add to from several threads */
+class GraphCounters {
+public:
+	/** add the counts of one finished query */
+	void record(const QueryCounters& query);
+
+	/** return the totals so far */
+	QueryCounters snapshot() const;
+
+	/** set the totals back to 0 */
+	void reset();
+
+private:
+	std::atomic<long long> queries{ 0 };
+	std::atomic<long long> verticesSettled{ 0 };
+	std::atomic<long long> edgesRelaxed{ 0 };
+	std::atomic<long long> heapPushes{ 0 };
+	std::atomic<long long> stalePops{ 0 };
+	/** vertexList loads by index, see QueryCounters::vertexLookups */
+	std::atomic<long long> vertexLookups{ 0 };
+	std::atomic<long long> neighborResets{ 0 };
+	std::atomic<long long> frontierHighWater{ 0 };
+};  // end GraphCounters
+
+#endif  // QUERYCOUNTERS_H
@@ -0,0 +1,209 @@
+// File Name: relaxkernel.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <atomic>
+#include <climits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RELAX_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "relaxkernel.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** signature shared by all kernels, see relaxEdges */
+typedef int (*RelaxFunction)(const Edge* edges, int count, int cost,
+	const int* distance, const unsigned int* reachedMark,
+	unsigned int epoch, int* improved);
+
+/** edges from first on, one at a time, also the tail of the others */
+static int relaxScalar(const Edge* edges, int first, int count, int cost,
+	const int* distance, const unsigned int* reachedMark,
+	unsigned int epoch, int* improved)
+{
+	int found = 0;
+	for (int i = first; i < count; i++)
+	{
+		int u = edges[i].getEndVertex();
+		int now = reachedMark[u] == epoch ? distance[u] : INT_MAX;
+		if (cost + edges[i].getWeight() < now)
+			improved[found++] = i;
+	}
+	return found;
+}
+
+static int relaxScalarKernel(const Edge* edges, int count, int cost,
+	const int* distance, const unsigned int* reachedMark,
+	unsigned int epoch, int* improved)
+{
+	return relaxScalar(edges, 0, count, cost, distance, reachedMark, epoch,
+		improved);
+}
+
+#ifdef RELAX_X86_KERNELS
+
+/** 8 edges at a time
+an Edge is end vertex then weight, so two loads hold 8 of each
+interleaved, a permute puts ends in the low half, weights in the high */
+__attribute__((target("avx2")))
+static int relaxAvx2Kernel(const Edge* edges, int count, int cost,
+	const int* distance, const unsigned int* reachedMark,
+	unsigned int epoch, int* improved)
+{
+	const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+	const __m256i costs = _mm256_set1_epi32(cost);
+	const __m256i epochs = _mm256_set1_epi32(static_cast<int>(epoch));
+	const __m256i unreached = _mm256_set1_epi32(INT_MAX);
+	const int* raw = reinterpret_cast<const int*>(edges);
+	int found = 0;
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i a = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(raw + 2 * i)), split);
+		__m256i b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(raw + 2 * i + 8)), split);
+		__m256i ends = _mm256_permute2x128_si256(a, b, 0x20);
+		__m256i weights = _mm256_permute2x128_si256(a, b, 0x31);
+
+		__m256i marks = _mm256_i32gather_epi32(
+			reinterpret_cast<const int*>(reachedMark), ends, 4);
+		__m256i now = _mm256_i32gather_epi32(distance, ends, 4);
+		now = _mm256_blendv_epi8(unreached, now,
+			_mm256_cmpeq_epi32(marks, epochs));
+		__m256i lower = _mm256_cmpgt_epi32(now,
+			_mm256_add_epi32(costs, weights));
+		unsigned int mask = static_cast<unsigned int>(
+			_mm256_movemask_ps(_mm256_castsi256_ps(lower)));
+		while (mask != 0)
+		{
+			improved[found++] = i + __builtin_ctz(mask);
+			mask &= mask - 1;
+		}
+	}
+	return found + relaxScalar(edges, i, count, cost, distance, reachedMark,
+		epoch, improved + found);
+}
+
+/** 16 edges at a time, two-source permutes split ends from weights
+and a compressing store writes the improved positions */
+__attribute__((target("avx512f")))
+static int relaxAvx512Kernel(const Edge* edges, int count, int cost,
+	const int* distance, const unsigned int* reachedMark,
+	unsigned int epoch, int* improved)
+{
+	const __m512i evens = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+		16, 18, 20, 22, 24, 26, 28, 30);
+	const __m512i odds = _mm512_add_epi32(evens, _mm512_set1_epi32(1));
+	const __m512i costs = _mm512_set1_epi32(cost);
+	const __m512i epochs = _mm512_set1_epi32(static_cast<int>(epoch));
+	const __m512i unreached = _mm512_set1_epi32(INT_MAX);
+	const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+		8, 9, 10, 11, 12, 13, 14, 15);
+	const int* raw = reinterpret_cast<const int*>(edges);
+	int found = 0;
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m512i a = _mm512_loadu_si512(raw + 2 * i);
+		__m512i b = _mm512_loadu_si512(raw + 2 * i + 16);
+		__m512i ends = _mm512_permutex2var_epi32(a, evens, b);
+		__m512i weights = _mm512_permutex2var_epi32(a, odds, b);
+
+		__m512i marks = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(),
+			0xffff, ends, reachedMark, 4);
+		__mmask16 reached = _mm512_cmpeq_epi32_mask(marks, epochs);
+		__m512i now = _mm512_mask_i32gather_epi32(unreached, reached, ends,
+			distance, 4);
+		__mmask16 lower = _mm512_cmplt_epi32_mask(
+			_mm512_add_epi32(costs, weights), now);
+		_mm512_mask_compressstoreu_epi32(improved + found, lower,
+			_mm512_add_epi32(lanes, _mm512_set1_epi32(i)));
+		found += __builtin_popcount(lower);
+	}
+	return found + relaxScalar(edges, i, count, cost, distance, reachedMark,
+		epoch, improved + found);
+}
+
+#endif  // RELAX_X86_KERNELS
+
+/** return true if this CPU can run kernel */
+bool isRelaxKernelSupported(RelaxKernel kernel)
+{
+#ifdef RELAX_X86_KERNELS
+	__builtin_cpu_init(); // may run before main, from currentKernel
+#endif
+	switch (kernel)
+	{
+	case RelaxKernel::Scalar:
+		return true;
+#ifdef RELAX_X86_KERNELS
+	case RelaxKernel::Avx2:
+		return __builtin_cpu_supports("avx2");
+	case RelaxKernel::Avx512:
+		return __builtin_cpu_supports("avx512f");
+#endif
+	default:
+		return false;
+	}
+}
+
+/** return the function for a supported kernel */
+static RelaxFunction relaxFunction(RelaxKernel kernel)
+{
+#ifdef RELAX_X86_KERNELS
+	if (kernel == RelaxKernel::Avx512)
+		return relaxAvx512Kernel;
+	if (kernel == RelaxKernel::Avx2)
+		return relaxAvx2Kernel;
+#endif
+	(void)kernel;
+	return relaxScalarKernel;
+}
+
+/** return the fastest kernel this CPU can run */
+static RelaxKernel bestRelaxKernel()
+{
+	if (isRelaxKernelSupported(RelaxKernel::Avx512))
+		return RelaxKernel::Avx512;
+	if (isRelaxKernelSupported(RelaxKernel::Avx2))
+		return RelaxKernel::Avx2;
+	return RelaxKernel::Scalar;
+}
+
+/** kernel in use, chosen once before main */
+static std::atomic<RelaxKernel> currentKernel(bestRelaxKernel());
+static std::atomic<RelaxFunction> currentFunction(
+	relaxFunction(currentKernel.load()));
+
+/** write the position of every edge in edges[0 .. count - 1] with
+cost + weight below its end vertex's current cost to improved
+@return number of positions written, they are in increasing order */
+int relaxEdges(const Edge* edges, int count, int cost,
+	const int* distance, const unsigned int* reachedMark,
+	unsigned int epoch, int* improved)
+{
+	RelaxFunction relax = currentFunction.load(std::memory_order_relaxed);
+	return relax(edges, count, cost, distance, reachedMark, epoch, improved);
+}
+
+/** return the kernel relaxEdges uses */
+RelaxKernel getRelaxKernel() { return currentKernel.load(); }
+
+/** make relaxEdges use kernel for the whole program
+@return false, and nothing changes, if the CPU cannot run it */
+bool setRelaxKernel(RelaxKernel kernel)
+{
+	if (!isRelaxKernelSupported(kernel))
+		return false;
+	currentKernel.store(kernel);
+	currentFunction.store(relaxFunction(kernel));
+	return true;
+}
@@ -0,0 +1,38 @@
+/**
+* Edge relaxation kernels for the shortest path inner loop
+* Given a vertex's edges and its final cost, find every edge that
+* gives its end vertex a lower tentative cost than it has now:
+* gather the end vertices' costs, add the weights, compare
+* AVX2 does 8 edges at a time, AVX-512 16, the scalar kernel is the
+* fallback, the best one the CPU supports is chosen when the program
+* starts, setRelaxKernel picks another one for tests and benchmarks
+* A vertex's cost only counts if reachedMark[vertex] == epoch, the
+* same marks QueryContext keeps, see QueryContext::findImprovedEdges
+*/
+
+#ifndef RELAXKERNEL_H
+#define RELAXKERNEL_H
+
+#include "edge.h"
+
+/** the kernels, fastest last */
+enum class RelaxKernel { Scalar, Avx2, Avx512 };
+
+/** write the position of every edge in edges[0 .. count - 1] with
+cost + weight below its end vertex's current cost to improved
+@return number of positions written, they are in increasing order */
+int relaxEdges(const Edge* edges, int count, int cost,
+	const int* distance, const unsigned int* reachedMark,
+	unsigned int epoch, int* improved);
+
+/** return true if this CPU can run kernel */
+bool isRelaxKernelSupported(RelaxKernel kernel);
+
+/** return the kernel relaxEdges uses */
+RelaxKernel getRelaxKernel();
+
+/** make relaxEdges use kernel for the whole program
+@return false, and nothing changes, if the CPU cannot run it */
+bool setRelaxKernel(RelaxKernel kernel);
+
+#endif  // RELAXKERNEL_H
@@ -0,0 +1,31 @@
+/**
+* Limits for a bounded Djikstra, see Graph::djikstraCostToAllVertices
+* The search stops at the first limit it reaches, the defaults never
+* stop it, so a default SearchLimits searches everything reachable
+* Only vertices the search settled are in the result, their costs and
+* paths are final, vertices it saw but did not settle are left out
+* Edge weights must not be negative
+*/
+
+#ifndef SEARCHLIMITS_H
+#define SEARCHLIMITS_H
+
+#include <climits>
+#include <string>
+#include <vector>
+
+struct SearchLimits {
+	/** leave out vertices costing more than this, every vertex within
+	it is found, edges past it are never put on the heap */
+	int maxCost{ INT_MAX };
+	/** stop after settling this many vertices, the start counts as
+	one and is always settled */
+	int maxSettled{ INT_MAX };
+	/** stop once every one of these is settled, labels not in the
+	graph are never settled, empty means no targets */
+	std::vector<std::string> targets;
+	/** stop once any one target is settled, the nearest one */
+	bool anyTarget{ false };
+};
+
+#endif  // SEARCHLIMITS_H
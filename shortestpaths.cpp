@@ -0,0 +1,92 @@
+// File Name: shortestpaths.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "shortestpaths.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** constructor, empty result */
+ShortestPaths::ShortestPaths() {}
+
+/** return label of the start vertex, "" if empty */
+const std::string& ShortestPaths::getStart() const
+{
+	static const std::string none;
+	return startIndex == -1 ? none : graph->getVertexLabel(startIndex);
+}
+
+/** return index of the start vertex, -1 if empty */
+int ShortestPaths::getStartIndex() const { return startIndex; }
+
+/** return true if vertex can be reached from start
+the start vertex is always reachable with cost 0 */
+bool ShortestPaths::isReachable(const std::string& label) const
+{
+	return graph != nullptr && isReachable(graph->getVertexIndex(label));
+}
+
+bool ShortestPaths::isReachable(int index) const
+{
+	return index >= 0 && index < static_cast<int>(cost.size()) &&
+		cost[index] != INT_MAX;
+}
+
+/** return the lowest cost to vertex, INT_MAX if unreachable */
+int ShortestPaths::getCost(const std::string& label) const
+{
+	if (graph == nullptr)
+		return INT_MAX;
+	return getCost(graph->getVertexIndex(label));
+}
+
+int ShortestPaths::getCost(int index) const
+{ return isReachable(index) ? cost[index] : INT_MAX; }
+
+/** return the vertex before this one on the path
+-1 for the start vertex and unreachable vertices */
+int ShortestPaths::getPrevious(int index) const
+{ return isReachable(index) ? previous[index] : -1; }
+
+/** return the path from start to target, both included
+empty if target is unreachable or not in the graph */
+std::vector<std::string> ShortestPaths::pathTo(
+	const std::string& target) const
+{
+	std::vector<std::string> path;
+	if (graph == nullptr)
+		return path;
+	std::vector<int> indices = pathIndicesTo(graph->getVertexIndex(target));
+	path.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i++)
+		path.push_back(graph->getVertexLabel(indices[i]));
+	return path;
+}
+
+/** return the path as vertex indices, start to target */
+std::vector<int> ShortestPaths::pathIndicesTo(int target) const
+{
+	std::vector<int> path;
+	if (!isReachable(target))
+		return path;
+	for (int v = target; v != -1; v = previous[v])
+		path.push_back(v);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+/** flat arrays, position is Vertex::getIndex */
+const std::vector<int>& ShortestPaths::getCosts() const { return cost; }
+
+const std::vector<int>& ShortestPaths::getPreviousVertices() const
+{ return previous; }
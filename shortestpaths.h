@@ -0,0 +1,128 @@
+/**
+* Results of a single-source shortest path query
+* ShortestPaths keeps the whole result
+* SettledVertex is one record handed to a streaming sink
+* WeightedPath is one path with its total cost
+*
+* ShortestPaths:
+* Costs and previous vertices are kept in flat arrays indexed by
+* vertex index, so building a result is two array fills
+* pathTo walks the previous array and returns the path directly
+* The graph the result came from must outlive it
+*/
+
+#ifndef SHORTESTPATHS_H
+#define SHORTESTPATHS_H
+
+#include <string>
+#include <vector>
+
+class Graph;
+
+class SettledVertex {
+public:
+	/** constructor, previousLabel is nullptr for the start vertex */
+	SettledVertex(int index, const std::string& label, int cost,
+		int previousIndex, const std::string* previousLabel)
+		: vertexIndex(index), vertexLabel(label), vertexCost(cost),
+		prevIndex(previousIndex), prevLabel(previousLabel) {}
+
+	/** return index of the settled vertex */
+	int getIndex() const { return vertexIndex; }
+
+	/** return label of the settled vertex */
+	const std::string& getLabel() const { return vertexLabel; }
+
+	/** return the final lowest cost to this vertex */
+	int getCost() const { return vertexCost; }
+
+	/** return true if this is not the start vertex */
+	bool hasPrevious() const { return prevLabel != nullptr; }
+
+	/** return index of the vertex before this one, -1 for the start */
+	int getPreviousIndex() const { return prevIndex; }
+
+	/** return label of the vertex before this one, "" for the start */
+	const std::string& getPreviousLabel() const
+	{
+		static const std::string none;
+		return prevLabel == nullptr ? none : *prevLabel;
+	}
+
+private:
+	int vertexIndex;
+	const std::string& vertexLabel;
+	int vertexCost;
+	int prevIndex;
+	const std::string* prevLabel;
+};  // end SettledVertex
+
+class WeightedPath {
+public:
+	/** constructor, path as vertex labels and its total cost */
+	WeightedPath(std::vector<std::string> labels, int totalCost)
+		: vertices(labels), cost(totalCost) {}
+
+	/** return the vertices on the path, start and end included */
+	const std::vector<std::string>& getVertices() const { return vertices; }
+
+	/** return the sum of the edge weights along the path */
+	int getCost() const { return cost; }
+
+private:
+	std::vector<std::string> vertices;
+	int cost;
+};  // end WeightedPath
+
+class ShortestPaths {
+public:
+	/** constructor, empty result */
+	ShortestPaths();
+
+	/** return label of the start vertex, "" if empty */
+	const std::string& getStart() const;
+
+	/** return index of the start vertex, -1 if empty */
+	int getStartIndex() const;
+
+	/** return true if vertex can be reached from start
+	the start vertex is always reachable with cost 0 */
+	bool isReachable(const std::string& label) const;
+	bool isReachable(int index) const;
+
+	/** return the lowest cost to vertex, INT_MAX if unreachable */
+	int getCost(const std::string& label) const;
+	int getCost(int index) const;
+
+	/** return the vertex before this one on the path
+	-1 for the start vertex and unreachable vertices */
+	int getPrevious(int index) const;
+
+	/** return the path from start to target, both included
+	empty if target is unreachable or not in the graph */
+	std::vector<std::string> pathTo(const std::string& target) const;
+
+	/** return the path as vertex indices, start to target */
+	std::vector<int> pathIndicesTo(int target) const;
+
+	/** flat arrays, position is Vertex::getIndex */
+	const std::vector<int>& getCosts() const;
+	const std::vector<int>& getPreviousVertices() const;
+
+private:
+	friend class Graph;
+
+	/** graph the query ran on, used to translate labels */
+	const Graph* graph{ nullptr };
+
+	/** index of the start vertex */
+	int startIndex{ -1 };
+
+	/** cost[i] is the lowest cost to i, INT_MAX if unreachable */
+	std::vector<int> cost;
+
+	/** previous[i] is the vertex before i on the path, or -1 */
+	std::vector<int> previous;
+};  // end ShortestPaths
+
+#endif  // SHORTESTPATHS_H
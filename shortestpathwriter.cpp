@@ -0,0 +1,112 @@
+// File Name: shortestpathwriter.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "shortestpathwriter.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** open filename for writing, replacing it
+records are collected in a buffer of bufferSize bytes */
+ShortestPathWriter::ShortestPathWriter(const std::string& filename,
+	Format format, size_t bufferSize)
+	: out(filename, std::ios::out | std::ios::binary | std::ios::trunc),
+	recordFormat(format), buffer(bufferSize < 64 ? 64 : bufferSize)
+{
+	if (!out.is_open())
+	{
+		std::cerr << "Could not open file: " << filename;
+		failed = true;
+	}
+}
+
+/** destructor, flushes what is left in the buffer */
+ShortestPathWriter::~ShortestPathWriter() { flush(); }
+
+/** return true if the file could be opened */
+bool ShortestPathWriter::isOpen() const { return out.is_open(); }
+
+/** write one record, the sink interface used by djikstraStream */
+void ShortestPathWriter::operator()(const SettledVertex& record)
+{
+	if (recordFormat == Format::Binary)
+	{
+		int32_t fields[3] = { record.getIndex(), record.getCost(),
+			record.getPreviousIndex() };
+		unsigned char bytes[12];
+		for (int f = 0; f < 3; f++) // little-endian whatever the host
+		{
+			uint32_t value = static_cast<uint32_t>(fields[f]);
+			for (int b = 0; b < 4; b++)
+				bytes[f * 4 + b] = static_cast<unsigned char>(value >> (8 * b));
+		}
+		append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+	}
+	else
+	{
+		char cost[24]; // "   -2147483648   " is 17 and the NUL
+		int length = std::snprintf(cost, sizeof(cost), "   %d   ",
+			record.getCost());
+		if (length < 0 || length >= static_cast<int>(sizeof(cost)))
+			length = 0;
+		append(record.getLabel().data(), record.getLabel().size());
+		append(cost, static_cast<size_t>(length));
+		if (record.hasPrevious()) // no copy of the label
+			append(record.getPreviousLabel().data(),
+				record.getPreviousLabel().size());
+		else
+			append("-", 1);
+		append("\n", 1);
+	}
+	records++;
+}
+
+/** write the buffer out to the file
+@return  false if this or any earlier write failed, see good */
+bool ShortestPathWriter::flush()
+{
+	if (used > 0 && out.is_open())
+		out.write(buffer.data(), static_cast<std::streamsize>(used));
+	used = 0;
+	out.flush();
+	if (!out)
+		failed = true;
+	return !failed;
+}
+
+/** return false once the file could not be opened or a write or
+flush failed, such as a full disk, records after that are lost */
+bool ShortestPathWriter::good() const { return !failed; }
+
+/** return number of records written so far */
+long long ShortestPathWriter::getRecordCount() const { return records; }
+
+/** add bytes to the buffer, flushing when it is full
+long labels bigger than the buffer go straight to the file */
+void ShortestPathWriter::append(const char* bytes, size_t length)
+{
+	if (used + length > buffer.size())
+	{
+		flush();
+		if (length > buffer.size())
+		{
+			out.write(bytes, static_cast<std::streamsize>(length));
+			if (!out)
+				failed = true;
+			return;
+		}
+	}
+	std::copy(bytes, bytes + length, buffer.begin() + used);
+	used += length;
+}
@@ -0,0 +1,64 @@
+/**
+* Buffered file sink for Graph::djikstraStream
+* Writes one record per settled vertex without keeping them in memory
+* Text format, one line per vertex, same spacing as readFile input
+*   vertex  cost  previous      previous is "-" for the start vertex
+* Binary format, three little-endian 32-bit ints per vertex
+*   vertexIndex  cost  previousIndex     previousIndex is -1 for start
+*   labels are Graph::getVertexLabel(index)
+*/
+
+#ifndef SHORTESTPATHWRITER_H
+#define SHORTESTPATHWRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "shortestpaths.h"
+
+class ShortestPathWriter {
+public:
+	/** how records are written */
+	enum class Format { Text, Binary };
+
+	/** open filename for writing, replacing it
+	records are collected in a buffer of bufferSize bytes */
+	ShortestPathWriter(const std::string& filename, Format format,
+		size_t bufferSize = 1 << 16);
+
+	/** destructor, flushes what is left in the buffer */
+	~ShortestPathWriter();
+
+	/** return true if the file could be opened */
+	bool isOpen() const;
+
+	/** write one record, the sink interface used by djikstraStream */
+	void operator()(const SettledVertex& record);
+
+	/** write the buffer out to the file
+	@return  false if this or any earlier write failed, see good */
+	bool flush();
+
+	/** return false once the file could not be opened or a write or
+	flush failed, such as a full disk, records after that are lost */
+	bool good() const;
+
+	/** return number of records written so far */
+	long long getRecordCount() const;
+
+private:
+	/** add bytes to the buffer, flushing when it is full */
+	void append(const char* bytes, size_t length);
+
+	std::ofstream out;
+	Format recordFormat;
+	std::vector<char> buffer;
+	size_t used{ 0 };
+	long long records{ 0 };
+
+	/** set once a write fails, it stays set */
+	bool failed{ false };
+};  // end ShortestPathWriter
+
+#endif  // SHORTESTPATHWRITER_H
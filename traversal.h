@@ -0,0 +1,73 @@
+/**
+* Types shared by the templated traversals
+* A visitor is any callable taking either a const TraversalVisit&
+* or the vertex label as a const std::string&
+* A visitor may return a TraversalControl to skip or stop,
+* a visitor returning void always continues
+*/
+
+#ifndef TRAVERSAL_H
+#define TRAVERSAL_H
+
+#include <string>
+#include <type_traits>
+
+/** what the traversal should do after visiting a vertex */
+enum class TraversalControl {
+	/** keep going, explore the neighbors of this vertex */
+	Continue,
+	/** keep going, but do not explore from this vertex */
+	SkipChildren,
+	/** end the traversal now */
+	Stop
+};
+
+class TraversalVisit {
+public:
+	/** constructor with index, label and depth from the start vertex */
+	TraversalVisit(int index, const std::string& label, int depth)
+		: vertexIndex(index), vertexLabel(label), vertexDepth(depth) {}
+
+	/** return the index of the vertex in its graph */
+	int getIndex() const { return vertexIndex; }
+
+	/** return the label of the vertex, valid while the graph is */
+	const std::string& getLabel() const { return vertexLabel; }
+
+	/** return the number of edges from the start vertex in the
+	traversal tree, 0 for the start vertex */
+	int getDepth() const { return vertexDepth; }
+
+private:
+	int vertexIndex;
+	const std::string& vertexLabel;
+	int vertexDepth;
+};  // end TraversalVisit
+
+/** call visitor with arg and translate its answer,
+a visitor returning void continues */
+template <typename Visitor, typename Arg>
+TraversalControl controlOf(Visitor& visitor, const Arg& arg)
+{
+	typedef std::invoke_result_t<Visitor&, const Arg&> R;
+	if constexpr (std::is_void_v<R>)
+	{
+		visitor(arg);
+		return TraversalControl::Continue;
+	}
+	else
+		return visitor(arg);
+}
+
+/** call visitor on a vertex with the visit or its label,
+whichever the visitor takes, and translate its answer */
+template <typename Visitor>
+TraversalControl callVisitor(Visitor& visitor, const TraversalVisit& visit)
+{
+	if constexpr (std::is_invocable_v<Visitor&, const TraversalVisit&>)
+		return controlOf(visitor, visit);
+	else
+		return controlOf(visitor, visit.getLabel());
+}
+
+#endif  // TRAVERSAL_H
@@ -0,0 +1,165 @@
+// File Name: traversalrange.cpp
+// Class Method Programmer: Tabitha Roemish
+// Date: 2/14/2017
+
+#include <memory>
+#include <vector>
+
+#include "graph.h"
+#include "traversalrange.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** only Graph::dfs creates ranges, start is visited immediately */
+DepthFirstRange::DepthFirstRange(const Graph& g, const Vertex* start,
+	QueryContext* queryContext)
+{
+	graph = &g;
+	context = queryContext;
+	if (context == nullptr)
+	{
+		ownContext.reset(new QueryContext());
+		context = ownContext.get();
+	}
+	context->beginQuery(graph->getNumVertices());
+	context->visit(start->getIndex());
+	context->getStack().push_back(QueryContext::DfsFrame(
+		start->getIndex(), start->getAdjacencyList().begin()));
+	GRAPH_COUNT(context->getCounters(), neighborResets, 1);
+	currentVertex = start;
+	currentDepth = 0;
+	finished = false;
+}
+
+/** iterator at the current vertex, the start vertex at first */
+DepthFirstRange::iterator DepthFirstRange::begin()
+{ return finished ? iterator() : iterator(this); }
+
+/** iterator past the last vertex */
+DepthFirstRange::iterator DepthFirstRange::end() { return iterator(); }
+
+/** the vertex the traversal is at */
+TraversalVisit DepthFirstRange::current() const
+{
+	return TraversalVisit(currentVertex->getIndex(),
+		currentVertex->getLabel(), currentDepth);
+}
+
+/** move on to the next vertex, false if there are no more
+same steps as Graph::depthFirstTraversalHelper, one vertex at a time */
+bool DepthFirstRange::advance()
+{
+	std::vector<QueryContext::DfsFrame>& mystack = context->getStack();
+	QueryCounters& counters = context->getCounters();
+	while (!mystack.empty())
+	{
+		QueryContext::DfsFrame& top = mystack.back();
+		const Vertex* vertex = graph->vertexList[top.first];
+		while (top.second != vertex->getAdjacencyList().end())
+		{
+			const Vertex* next =
+				graph->vertexList[top.second->getEndVertex()];
+			GRAPH_COUNT(counters, vertexLookups, 1);
+			top.second++;
+			if (!context->isVisited(next->getIndex()))
+			{
+				context->visit(next->getIndex());
+				currentVertex = next;
+				currentDepth = static_cast<int>(mystack.size());
+				mystack.push_back(QueryContext::DfsFrame(next->getIndex(),
+					next->getAdjacencyList().begin()));
+				GRAPH_COUNT(counters, neighborResets, 1);
+				GRAPH_COUNT_MAX(counters, frontierHighWater,
+					static_cast<long long>(mystack.size()));
+				return true;
+			}
+		}
+		mystack.pop_back();
+	}
+	finished = true;
+	graph->recordQuery(*context);
+	return false;
+}
+
+/** only Graph::bfs creates ranges, start is visited immediately */
+BreadthFirstRange::BreadthFirstRange(const Graph& g, const Vertex* start,
+	QueryContext* queryContext)
+{
+	graph = &g;
+	context = queryContext;
+	if (context == nullptr)
+	{
+		ownContext.reset(new QueryContext());
+		context = ownContext.get();
+	}
+	context->beginQuery(graph->getNumVertices());
+	context->visit(start->getIndex());
+	context->getFrontier().push_back(start->getIndex());
+	currentVertex = start;
+	currentDepth = 0;
+	finished = false;
+}
+
+/** iterator at the current vertex, the start vertex at first */
+BreadthFirstRange::iterator BreadthFirstRange::begin()
+{ return finished ? iterator() : iterator(this); }
+
+/** iterator past the last vertex */
+BreadthFirstRange::iterator BreadthFirstRange::end() { return iterator(); }
+
+/** the vertex the traversal is at */
+TraversalVisit BreadthFirstRange::current() const
+{
+	return TraversalVisit(currentVertex->getIndex(),
+		currentVertex->getLabel(), currentDepth);
+}
+
+/** move on to the next vertex, false if there are no more
+same steps as Graph::breadthFirstTraversalHelper, one vertex at a time
+nextNeighbor remembers where in the head vertex's neighbors we stopped */
+bool BreadthFirstRange::advance()
+{
+	std::vector<int>& myqueue = context->getFrontier();
+	QueryCounters& counters = context->getCounters();
+	while (head < myqueue.size())
+	{
+		const Vertex* vertex = graph->vertexList[myqueue[head]];
+		if (!headStarted)
+		{
+			if (head == levelEnd)
+			{
+				depth++;
+				levelEnd = myqueue.size();
+			}
+			nextNeighbor = vertex->getAdjacencyList().begin();
+			headStarted = true;
+			GRAPH_COUNT(counters, neighborResets, 1);
+		}
+		while (nextNeighbor != vertex->getAdjacencyList().end())
+		{
+			const Vertex* next =
+				graph->vertexList[nextNeighbor->getEndVertex()];
+			GRAPH_COUNT(counters, vertexLookups, 1);
+			nextNeighbor++;
+			if (!context->isVisited(next->getIndex()))
+			{
+				context->visit(next->getIndex());
+				myqueue.push_back(next->getIndex());
+				GRAPH_COUNT_MAX(counters, frontierHighWater,
+					static_cast<long long>(myqueue.size() - head));
+				currentVertex = next;
+				currentDepth = depth + 1;
+				return true;
+			}
+		}
+		head++;
+		headStarted = false;
+	}
+	finished = true;
+	graph->recordQuery(*context);
+	return false;
+}
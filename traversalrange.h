@@ -0,0 +1,137 @@
+/**
+* Lazy depth-first and breadth-first traversals for range-for
+* for (TraversalVisit v : graph.bfs("A")) ...
+* Each step of the loop advances the traversal by exactly one vertex,
+* so breaking out early leaves the rest of the graph untouched
+* Vertices come out in the same order as depthFirstTraversal and
+* breadthFirstTraversal
+* A range uses its own QueryContext unless one is passed to
+* Graph::dfs or Graph::bfs, the graph must outlive the range
+* With GRAPH_COUNTERS the range's work is added to Graph::getCounters
+* only once it has run to the end
+*/
+
+#ifndef TRAVERSALRANGE_H
+#define TRAVERSALRANGE_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+
+#include "querycontext.h"
+#include "traversal.h"
+#include "vertex.h"
+
+class Graph;
+
+/** input iterator shared by both ranges, Range supplies advance() */
+template <typename Range>
+class TraversalIterator {
+public:
+	typedef std::input_iterator_tag iterator_category;
+	typedef TraversalVisit value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef void pointer;
+	typedef TraversalVisit reference;
+
+	/** end iterator */
+	TraversalIterator() {}
+
+	/** iterator at the current vertex of range */
+	explicit TraversalIterator(Range* range) : owner(range) {}
+
+	/** the vertex the traversal is at */
+	TraversalVisit operator*() const { return owner->current(); }
+
+	/** move the traversal on by one vertex */
+	TraversalIterator& operator++()
+	{
+		if (!owner->advance())
+			owner = nullptr;
+		return *this;
+	}
+
+	/** iterators are equal if both are at the end or share a range */
+	bool operator==(const TraversalIterator& other) const
+	{ return owner == other.owner; }
+	bool operator!=(const TraversalIterator& other) const
+	{ return owner != other.owner; }
+
+private:
+	Range* owner{ nullptr };
+};  // end TraversalIterator
+
+class DepthFirstRange {
+public:
+	typedef TraversalIterator<DepthFirstRange> iterator;
+
+	/** iterator at the current vertex, the start vertex at first */
+	iterator begin();
+
+	/** iterator past the last vertex */
+	iterator end();
+
+	/** the vertex the traversal is at */
+	TraversalVisit current() const;
+
+	/** move on to the next vertex, false if there are no more */
+	bool advance();
+
+private:
+	friend class Graph;
+
+	/** only Graph::dfs creates ranges, start is visited immediately */
+	DepthFirstRange(const Graph& graph, const Vertex* start,
+		QueryContext* context);
+
+	const Graph* graph;
+	std::unique_ptr<QueryContext> ownContext;
+	QueryContext* context;
+
+	/** vertex the traversal is at */
+	const Vertex* currentVertex;
+	int currentDepth;
+	bool finished;
+};  // end DepthFirstRange
+
+class BreadthFirstRange {
+public:
+	typedef TraversalIterator<BreadthFirstRange> iterator;
+
+	/** iterator at the current vertex, the start vertex at first */
+	iterator begin();
+
+	/** iterator past the last vertex */
+	iterator end();
+
+	/** the vertex the traversal is at */
+	TraversalVisit current() const;
+
+	/** move on to the next vertex, false if there are no more */
+	bool advance();
+
+private:
+	friend class Graph;
+
+	/** only Graph::bfs creates ranges, start is visited immediately */
+	BreadthFirstRange(const Graph& graph, const Vertex* start,
+		QueryContext* context);
+
+	const Graph* graph;
+	std::unique_ptr<QueryContext> ownContext;
+	QueryContext* context;
+
+	/** vertex the traversal is at */
+	const Vertex* currentVertex;
+	int currentDepth;
+	bool finished;
+
+	/** frontier position and where its neighbors are read from */
+	size_t head{ 0 };
+	size_t levelEnd{ 1 };
+	int depth{ 0 };
+	bool headStarted{ false };
+	Vertex::AdjacencyList::const_iterator nextNeighbor;
+};  // end BreadthFirstRange
+
+#endif  // TRAVERSALRANGE_H
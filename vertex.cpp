@@ -2,11 +2,11 @@
 // Class Method Programmer: Tabitha Roemish
 // Date: 2/14/2017
 
+#include <algorithm>
 #include <climits>
 #include "vertex.h"
-#include <functional>
-#include <map>
 #include <string>
+#include <vector>
 
 #include "edge.h"
 
@@ -16,55 +16,86 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 
-/** Creates an unvisited vertex, gives it a label, and clears its
+/** Creates a vertex, gives it a label and index, and clears its
 adjacency list.
 NOTE: A vertex must have a unique label that cannot be changed. */
-Vertex::Vertex(std::string label) 
+Vertex::Vertex(std::string label, int index) 
 {
-	visited = false;
 	vertexLabel = label;
-	resetNeighbor();
+	vertexIndex = index;
 }
 
 /** @return  The label of this vertex. */
-std::string Vertex::getLabel() const { return vertexLabel; }
+const std::string& Vertex::getLabel() const { return vertexLabel; }
 
-/** Marks this vertex as visited. */
-void Vertex::visit() { visited = true; }
-
-/** Marks this vertex as not visited. */
-void Vertex::unvisit() { visited = false; }
-
-/** Returns the visited status of this vertex.
-@return  True if the vertex has been visited, otherwise
-returns false/ */
-bool Vertex::isVisited() const { return visited; }
+/** @return  The index of this vertex in its graph. */
+int Vertex::getIndex() const { return vertexIndex; }
 
 /** Adds an edge between this vertex and the given vertex.
 Cannot have multiple connections to the same endVertex
 Cannot connect back to itself
+vertexList is the graph's index to vertex table, edges only hold
+indices so it is needed to keep them in label order
 @return  True if the connection is successful. */
-bool Vertex::connect(const std::string& endVertex, const int edgeWeight) 
+bool Vertex::connect(const Vertex& endVertex, const int edgeWeight,
+	const std::vector<Vertex*>& vertexList) 
 { 
-	if (adjacencyList.count(endVertex) > 0 || endVertex == this->getLabel())
+	AdjacencyList::const_iterator at = findEdge(endVertex, vertexList);
+	if ((at != adjacencyList.end() &&
+		at->getEndVertex() == endVertex.getIndex()) || &endVertex == this)
 		return false;
 	else
 	{
-		Edge newEdge(endVertex, edgeWeight);
-		adjacencyList[endVertex] = newEdge;
-		currentNeighbor = adjacencyList.begin();
+		adjacencyList.insert(at, Edge(endVertex.getIndex(), edgeWeight));
 		return true;
 	}
 }																			
 
+/** Adds many edges at once, like connect for each in order.
+a stable sort keeps the first edge to each vertex first, later ones,
+edges back to this vertex and edges already there are dropped, then
+the rest are appended and merged into place
+@param edges  the edges to add, left holding the ones connected
+@return  The number of edges connected. */
+int Vertex::connectAll(std::vector<Edge>& edges,
+	const std::vector<Vertex*>& vertexList)
+{
+	auto byLabel = [&vertexList](const Edge& a, const Edge& b) {
+		return vertexList[a.getEndVertex()]->getLabel() <
+			vertexList[b.getEndVertex()]->getLabel();
+	};
+	std::stable_sort(edges.begin(), edges.end(), byLabel);
+	size_t kept = 0;
+	int last = -1;
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		int end = edges[i].getEndVertex();
+		if (end == last || end == vertexIndex)
+			continue;
+		last = end;
+		AdjacencyList::const_iterator at =
+			findEdge(*vertexList[end], vertexList);
+		if (at == adjacencyList.end() || at->getEndVertex() != end)
+			edges[kept++] = edges[i];
+	}
+	edges.erase(edges.begin() + kept, edges.end());
+
+	size_t middle = adjacencyList.size();
+	adjacencyList.insert(adjacencyList.end(), edges.begin(), edges.end());
+	std::inplace_merge(adjacencyList.begin(), adjacencyList.begin() + middle,
+		adjacencyList.end(), byLabel);
+	return static_cast<int>(kept);
+}
+
 /** Removes the edge between this vertex and the given one.
 @return  True if the removal is successful. */
-bool Vertex::disconnect(const std::string& endVertex) 
+bool Vertex::disconnect(const Vertex& endVertex,
+	const std::vector<Vertex*>& vertexList) 
 {
-	std::map<std::string, Edge>::iterator ptr = adjacencyList.find(endVertex);
-	if (ptr != adjacencyList.end())
+	AdjacencyList::const_iterator at = findEdge(endVertex, vertexList);
+	if (at != adjacencyList.end() && at->getEndVertex() == endVertex.getIndex())
 	{
-		adjacencyList.erase(endVertex); // remove edge from list
+		adjacencyList.erase(at); // remove edge from list
 		return true;
 	}
 	else
@@ -73,45 +104,45 @@ bool Vertex::disconnect(const std::string& endVertex)
 
 /** Gets the weight of the edge between this vertex and the given vertex.
 @return  The edge weight. This value is zero for an unweighted graph and
-is negative if the .edge does not exist */
-int Vertex::getEdgeWeight(const std::string& endVertex) const 
+INT_MAX if the edge does not exist, weights can be negative */
+int Vertex::getEdgeWeight(const Vertex& endVertex,
+	const std::vector<Vertex*>& vertexList) const 
 { 
-	if(adjacencyList.find(endVertex) != adjacencyList.end())
+	AdjacencyList::const_iterator at = findEdge(endVertex, vertexList);
+	if (at != adjacencyList.end() && at->getEndVertex() == endVertex.getIndex())
 		//if graph is unweighted, the value will be zero here
-		return adjacencyList.at(endVertex).getWeight(); 
+		return at->getWeight(); 
 	else 
-		return -1; 
+		return INT_MAX; 
+}
+
+/** Changes the weight of the edge to the given vertex in place.
+the edge keeps its place, the order is by label not weight
+@param oldWeight  set to the weight before the change
+@return  True if the edge exists. */
+bool Vertex::setEdgeWeight(const Vertex& endVertex, int edgeWeight,
+	const std::vector<Vertex*>& vertexList, int& oldWeight)
+{
+	AdjacencyList::const_iterator at = findEdge(endVertex, vertexList);
+	if (at == adjacencyList.end() || at->getEndVertex() != endVertex.getIndex())
+		return false;
+	AdjacencyList::iterator edge =
+		adjacencyList.begin() + (at - adjacencyList.cbegin());
+	oldWeight = edge->getWeight();
+	edge->setWeight(edgeWeight);
+	return true;
 }
 
 /** Calculates how many neighbors this vertex has.
 @return  The number of the vertex's neighbors. */
 int Vertex::getNumberOfNeighbors() const { return adjacencyList.size(); }
 
-/** Sets current neighbor to first in adjacency list. */
-void Vertex::resetNeighbor() { currentNeighbor = adjacencyList.begin(); }
-
-/** Gets this vertex's next neighbor in the adjacency list.
-Neighbors are automatically sorted alphabetically via map
-Returns the vertex label if there are no more neighbors
-@return  The label of the vertex's next neighbor. */
-std::string Vertex::getNextNeighbor() 
-{ 
-	std::string current = this->getLabel();
-	std::map<std::string, Edge>::iterator it = adjacencyList.begin();
-	if (it == adjacencyList.end()) //empty list
-	{
-		return current;
-	}
-	it = adjacencyList.end();
-	it--;
-	current = currentNeighbor->first;
-	
-	if (it->first != currentNeighbor->first) //if not last neighbor
-		currentNeighbor++;
-	
-			
-	return current;
-}
+/** Gets the adjacency list, read only.
+Neighbors are sorted alphabetically by label
+Traversals iterate it directly, the vertex keeps no cursor
+@return  The edges leaving this vertex. */
+const Vertex::AdjacencyList& Vertex::getAdjacencyList() const 
+{ return adjacencyList; }
 
 /** Sees whether this vertex is equal to another one.
 Two vertices are equal if they have the same label. */
@@ -122,3 +153,16 @@ bool Vertex::operator==(const Vertex& rightHandItem) const
 Compares vertexLabel. */
 bool Vertex::operator<(const Vertex& rightHandItem) const 
 { return this->getLabel()< rightHandItem.getLabel(); }
+
+/** return the first edge whose end vertex label is not less than
+endVertex's label, the edge to endVertex if there is one
+binary search, labels are only looked at, never copied */
+Vertex::AdjacencyList::const_iterator Vertex::findEdge(
+	const Vertex& endVertex, const std::vector<Vertex*>& vertexList) const
+{
+	const std::string& label = endVertex.getLabel();
+	return std::lower_bound(adjacencyList.begin(), adjacencyList.end(), label,
+		[&vertexList](const Edge& edge, const std::string& key) {
+			return vertexList[edge.getEndVertex()]->getLabel() < key;
+		});
+}
@@ -2,67 +2,79 @@
 * Each vertex has a unique label
 * Can be connected to other vertices via weighted edges
 * Cannot be connected to itself
-* Used by depth-first search and breadth-first search
+* Has an index, its position in the graph, used by QueryContext
 * to keep track of if it has been visited or not
 */
 
 #ifndef VERTEX_H
 #define VERTEX_H
 
-#include <functional>
-#include <map>
 #include <string>
+#include <vector>
 
 #include "edge.h"
 
 class Vertex {
 public:
-	/** Creates an unvisited vertex, gives it a label, and clears its
+	/** adjacency list as a vector of edges, kept in alphabetical order
+	of the end vertex labels */
+	typedef std::vector<Edge> AdjacencyList;
+
+	/** Creates a vertex, gives it a label and index, and clears its
 	adjacency list.
 	NOTE: A vertex must have a unique label that cannot be changed. */
-	explicit Vertex(std::string label);
+	Vertex(std::string label, int index);
 
 	/** @return  The label of this vertex. */
-	std::string getLabel() const;
-
-	/** Marks this vertex as visited. */
-	void visit();
+	const std::string& getLabel() const;
 
-	/** Marks this vertex as not visited. */
-	void unvisit();
-
-	/** Returns the visited status of this vertex.
-	@return  True if the vertex has been visited, otherwise
-	returns false/ */
-	bool isVisited() const;
+	/** @return  The index of this vertex in its graph. */
+	int getIndex() const;
 
 	/** Adds an edge between this vertex and the given vertex.
 	Cannot have multiple connections to the same endVertex
 	Cannot connect back to itself
+	vertexList is the graph's index to vertex table, edges only hold
+	indices so it is needed to keep them in label order
 	@return  True if the connection is successful. */
-	bool connect(const std::string& endVertex, const int edgeWeight = 0);
+	bool connect(const Vertex& endVertex, const int edgeWeight,
+		const std::vector<Vertex*>& vertexList);
+
+	/** Adds many edges at once, like connect for each in order.
+	Each connect inserts into the sorted list, O(degree), so building
+	a hub one edge at a time is O(degree^2), this sorts the new edges
+	and merges them in once
+	@param edges  the edges to add, left holding the ones connected
+	@return  The number of edges connected. */
+	int connectAll(std::vector<Edge>& edges,
+		const std::vector<Vertex*>& vertexList);
 
 	/** Removes the edge between this vertex and the given one.
 	@return  True if the removal is successful. */
-	bool disconnect(const std::string& endVertex);
+	bool disconnect(const Vertex& endVertex,
+		const std::vector<Vertex*>& vertexList);
 
 	/** Gets the weight of the edge between this vertex and the given vertex.
 	@return  The edge weight. This value is zero for an unweighted graph and
-	is negative if the .edge does not exist */
-	int getEdgeWeight(const std::string& endVertex) const;
+	INT_MAX if the edge does not exist, weights can be negative */
+	int getEdgeWeight(const Vertex& endVertex,
+		const std::vector<Vertex*>& vertexList) const;
+
+	/** Changes the weight of the edge to the given vertex in place.
+	@param oldWeight  set to the weight before the change
+	@return  True if the edge exists. */
+	bool setEdgeWeight(const Vertex& endVertex, int edgeWeight,
+		const std::vector<Vertex*>& vertexList, int& oldWeight);
 
 	/** Calculates how many neighbors this vertex has.
 	@return  The number of the vertex's neighbors. */
 	int getNumberOfNeighbors() const;
 
-	/** Sets current neighbor to first in adjacency list. */
-	void resetNeighbor();
-
-	/** Gets this vertex's next neighbor in the adjacency list.
-	Neighbors are automatically sorted alphabetically via map
-	Returns the vertex label if there are no more neighbors
-	@return  The label of the vertex's next neighbor. */
-	std::string getNextNeighbor();
+	/** Gets the adjacency list, read only.
+	Neighbors are sorted alphabetically by label
+	Traversals iterate it directly, the vertex keeps no cursor
+	@return  The edges leaving this vertex. */
+	const AdjacencyList& getAdjacencyList() const;
 
 	/** Sees whether this vertex is equal to another one.
 	Two vertices are equal if they have the same label. */
@@ -73,17 +85,19 @@ public:
 	bool operator<(const Vertex& rightHandItem) const;
 
 private:
+	/** return the first edge whose end vertex label is not less than
+	endVertex's label, the edge to endVertex if there is one */
+	AdjacencyList::const_iterator findEdge(const Vertex& endVertex,
+		const std::vector<Vertex*>& vertexList) const;
+
 	/** the unique label for the vertex */
 	std::string vertexLabel;
 
-	/** True if the vertex is visited */
-	bool visited{ false };
-
-	/** adjacencyList as an ordered map, in alphabetical order */
-	std::map<std::string, Edge, std::less<std::string>> adjacencyList;
+	/** position of this vertex in its graph, cannot be changed */
+	int vertexIndex{ 0 };
 
-	/** iterator showing which neighbor we are currently at */
-	std::map<std::string, Edge>::iterator currentNeighbor;
+	/** adjacencyList in alphabetical order, 8 bytes per edge */
+	AdjacencyList adjacencyList;
 };
 
 #endif  // VERTEX_H
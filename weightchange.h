@@ -0,0 +1,29 @@
+/**
+* Edge weight changes, see Graph::updateWeight and Graph::updateWeights
+* WeightUpdate is one change asked for, by label
+* WeightChange is one change made, by vertex index, handed to the
+* graph's weight listeners so caches can fix up what depends on it
+*/
+
+#ifndef WEIGHTCHANGE_H
+#define WEIGHTCHANGE_H
+
+#include <string>
+
+struct WeightUpdate {
+	/** the edge from start to end gets weight */
+	std::string start;
+	std::string end;
+	int weight;
+};
+
+struct WeightChange {
+	/** vertex indices of the edge, Graph::getVertexLabel gives labels */
+	int start;
+	int end;
+	/** weight before and after */
+	int oldWeight;
+	int newWeight;
+};
+
+#endif  // WEIGHTCHANGE_H